@@ -0,0 +1,102 @@
+/**
+ *  @file       bitbench.cpp
+ *  @brief      Bit manipulation microbenchmark
+ *
+ *  @details    Times the different implementations of the bitboard
+ *              primitives in bitops.h on this host, so we can tell which
+ *              path the runtime dispatch should pick. Prints the detected
+ *              CPU features and nanoseconds per operation for each variant.
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "bitops.h"
+
+using namespace chrono;
+
+/*
+ *  a reference implementation that doesn't rely on any hardware support; the
+ *  software versions the dispatch falls back on are in bitops.h
+ */
+
+static int CsqPopcountLoop(uint64_t grf) noexcept
+{
+    int csq = 0;
+    for (; grf; grf = GrfClearLowest(grf))
+        csq++;
+    return csq;
+}
+
+/**
+ *  @fn         template <typename FN> void Time(const char* szName, const vector<uint64_t>& vgrf, FN fn)
+ *  @brief      Runs fn over the sample set enough times to get a stable
+ *              measurement and prints the time per call.
+ */
+
+static uint64_t grfSink = 0;
+
+template <typename FN>
+static void Time(const char* szName, const vector<uint64_t>& vgrf, FN fn)
+{
+    const int cpass = 200;
+    uint64_t grfSum = 0;
+    auto tpStart = high_resolution_clock::now();
+    for (int ipass = 0; ipass < cpass; ipass++)
+        for (size_t igrf = 0; igrf < vgrf.size(); igrf++)
+            grfSum += fn(vgrf[igrf], igrf);
+    auto tpEnd = high_resolution_clock::now();
+    grfSink += grfSum;
+    double ns = (double)duration_cast<nanoseconds>(tpEnd - tpStart).count();
+    cout << "  " << left << setw(24) << szName << right << fixed << setprecision(3)
+         << ns / ((double)cpass * vgrf.size()) << " ns" << endl;
+}
+
+int main(void)
+{
+    cout << "CPU: " << (cpuf.sVendor.empty() ? string("unknown") : cpuf.sVendor)
+         << "  popcnt " << cpuf.fPopcnt
+         << "  bmi1 " << cpuf.fBmi1
+         << "  bmi2 " << cpuf.fBmi2
+         << "  fast pext " << cpuf.fFastPext << endl;
+
+    /* sample data: sparse boards, like piece sets, and masks with the density
+       of slider occupancy masks */
+
+    mt19937_64 rand(0x5eed);
+    const size_t cgrf = 1 << 16;
+    vector<uint64_t> vgrf(cgrf), vgrfMask(cgrf);
+    for (size_t igrf = 0; igrf < cgrf; igrf++) {
+        vgrf[igrf] = (rand() & rand() & rand()) | 1;
+        vgrfMask[igrf] = rand() & rand() & 0x007e7e7e7e7e7e00ULL;
+    }
+
+    cout << "popcount" << endl;
+    Time("CsqPopcount", vgrf, [](uint64_t grf, size_t) { return (uint64_t)CsqPopcount(grf); });
+    Time("CsqPopcountSoft", vgrf, [](uint64_t grf, size_t) { return (uint64_t)CsqPopcountSoft(grf); });
+    Time("clear lowest loop", vgrf, [](uint64_t grf, size_t) { return (uint64_t)CsqPopcountLoop(grf); });
+
+    cout << "lowest bit" << endl;
+    Time("SqLowest", vgrf, [](uint64_t grf, size_t) { return (uint64_t)SqLowest(grf); });
+    Time("SqLowestSoft", vgrf, [](uint64_t grf, size_t) { return (uint64_t)SqLowestSoft(grf); });
+    Time("SqHighest", vgrf, [](uint64_t grf, size_t) { return (uint64_t)SqHighest(grf); });
+    Time("SqHighestSoft", vgrf, [](uint64_t grf, size_t) { return (uint64_t)SqHighestSoft(grf); });
+
+    cout << "pext" << endl;
+    Time("GrfPextSoft", vgrf, [&](uint64_t grf, size_t igrf) { return GrfPextSoft(grf, vgrfMask[igrf]); });
+#ifdef BITOPS_X64
+    if (cpuf.fBmi2)
+        Time("GrfPextBmi2", vgrf, [&](uint64_t grf, size_t igrf) { return GrfPextBmi2(grf, vgrfMask[igrf]); });
+#endif
+    Time("GrfPext (dispatched)", vgrf, [&](uint64_t grf, size_t igrf) { return GrfPext(grf, vgrfMask[igrf]); });
+
+    cout << "pdep" << endl;
+    Time("GrfPdepSoft", vgrf, [&](uint64_t grf, size_t igrf) { return GrfPdepSoft(grf, vgrfMask[igrf]); });
+#ifdef BITOPS_X64
+    if (cpuf.fBmi2)
+        Time("GrfPdepBmi2", vgrf, [&](uint64_t grf, size_t igrf) { return GrfPdepBmi2(grf, vgrfMask[igrf]); });
+#endif
+    Time("GrfPdep (dispatched)", vgrf, [&](uint64_t grf, size_t igrf) { return GrfPdep(grf, vgrfMask[igrf]); });
+
+    return grfSink == 0x5eed ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/**
+ *  @file       perftbench.cpp
+ *  @brief      Perft suite runner
+ *
+ *  @details    Runs every position in the perft test suite through the
+ *              hashed, multithreaded perft at every depth we have a count
+ *              for, up to a depth limit, and checks the counts. Prints the
+ *              time for each position and the totals at the end, and exits
+ *              with an error if any count is wrong, so it can be used to
+ *              validate move generator changes. Positions with no count at
+ *              or below the depth limit are skipped and reported as such.
+ *
+ *              perftbench [depth [threads [hash MB]]]
+ *
+ *              The default depth covers everything in the suite except the
+ *              very deep counts on the chessprogramming.org positions,
+ *              which run into the trillions of nodes.
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "perft.h"
+
+int main(int cs, char* as[])
+{
+    int dMax = cs > 1 ? atoi(as[1]) : dPerftSuiteMax;
+    int cthread = cs > 2 ? atoi(as[2]) : 0;
+    uint32_t cmbHash = cs > 3 ? (uint32_t)atoi(as[3]) : 256;
+
+    PERFT perft(cmbHash, cthread);
+    cout << "perft suite to depth " << dMax << ", " << perft.Cthread() << " threads, "
+         << cmbHash << " MB hash" << endl;
+
+    int cfail = 0;
+    int cskip = 0;
+    int64_t cmvTotal = 0;
+    auto tpStart = high_resolution_clock::now();
+
+    for (int iperft = 0; iperft < cperft; iperft++) {
+        const PERFTTEST& perfttest = aperft[iperft];
+        BD bd(perfttest.fen);
+        perft.Clear();
+        auto tpTest = high_resolution_clock::now();
+        int dLast = 0;
+        for (int d = 1; d <= dMax && perfttest.mpdcmv[d]; d++) {
+            if (perfttest.mpdcmv[d] < 0)
+                continue;
+            int64_t cmv = perft.CmvPerft(bd, d);
+            cmvTotal += cmv;
+            dLast = d;
+            if (cmv != perfttest.mpdcmv[d]) {
+                cout << perfttest.sTitle << " " << perfttest.fen << endl
+                     << "  depth " << d << ": expected " << perfttest.mpdcmv[d]
+                     << ", actual " << cmv << endl;
+                cfail++;
+                break;
+            }
+        }
+        if (dLast == 0) {
+            cout << "  " << left << setw(16) << perfttest.sTitle << right
+                 << " skipped, no count to depth " << dMax << endl;
+            cskip++;
+            continue;
+        }
+        milliseconds ms = duration_cast<milliseconds>(high_resolution_clock::now() - tpTest);
+        cout << "  " << left << setw(16) << perfttest.sTitle << right
+             << " depth " << setw(2) << dLast << setw(10) << ms.count() << " ms" << endl;
+    }
+
+    milliseconds ms = duration_cast<milliseconds>(high_resolution_clock::now() - tpStart);
+    cout << (cfail ? "FAILED " : "passed ") << cperft - cskip - cfail << "/" << cperft - cskip
+         << ", " << cskip << " skipped, " << cmvTotal << " leaf nodes in " << ms.count() << " ms" << endl;
+    return cfail ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+/**
+ *  @file       bitops.cpp
+ *  @brief      CPU feature detection
+ *
+ *  @details    The hardware bit operations are all inline in bitops.h; this
+ *              just finds out which of them the CPU we're running on has.
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "bitops.h"
+#include <cstring>
+
+#ifdef BITOPS_X64
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef BITOPS_X64
+
+/**
+ *  @fn         static void Cpuid(unsigned leaf, unsigned subleaf, unsigned mpreg[4])
+ *  @brief      Compiler-independent cpuid instruction
+ */
+
+static void Cpuid(unsigned leaf, unsigned subleaf, unsigned mpreg[4])
+{
+#ifdef _MSC_VER
+    int mpregT[4];
+    __cpuidex(mpregT, (int)leaf, (int)subleaf);
+    for (int ireg = 0; ireg < 4; ireg++)
+        mpreg[ireg] = (unsigned)mpregT[ireg];
+#else
+    mpreg[0] = mpreg[1] = mpreg[2] = mpreg[3] = 0;
+    __get_cpuid_count(leaf, subleaf, &mpreg[0], &mpreg[1], &mpreg[2], &mpreg[3]);
+#endif
+}
+
+#endif
+
+/**
+ *  @fn         CPUF::CPUF(void)
+ *  @brief      Detects the CPU features we care about
+ *
+ *  @details    AMD implemented PEXT and PDEP in microcode on Zen 1 and Zen 2
+ *              (families 17h and 18h), where they take hundreds of cycles
+ *              for dense masks. They are fast from Zen 3 (family 19h) on, and
+ *              on every Intel part that has them.
+ */
+
+CPUF::CPUF(void)
+{
+#ifdef BITOPS_X64
+    unsigned mpreg[4];
+    Cpuid(0, 0, mpreg);
+    unsigned leafMax = mpreg[0];
+    char szVendor[13];
+    memcpy(szVendor + 0, &mpreg[1], 4);
+    memcpy(szVendor + 4, &mpreg[3], 4);
+    memcpy(szVendor + 8, &mpreg[2], 4);
+    szVendor[12] = 0;
+    sVendor = szVendor;
+
+    Cpuid(1, 0, mpreg);
+    fPopcnt = (mpreg[2] >> 23) & 1;
+    unsigned family = (mpreg[0] >> 8) & 0x0f;
+    if (family == 0x0f)
+        family += (mpreg[0] >> 20) & 0xff;
+
+    if (leafMax >= 7) {
+        Cpuid(7, 0, mpreg);
+        fBmi1 = (mpreg[1] >> 3) & 1;
+        fBmi2 = (mpreg[1] >> 8) & 1;
+    }
+
+    fFastPext = fBmi2;
+    if ((sVendor == "AuthenticAMD" || sVendor == "HygonGenuine") && family < 0x19)
+        fFastPext = false;
+#endif
+}
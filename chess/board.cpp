@@ -21,6 +21,8 @@ const char fenStartPos[] =
 const char fenEmpty[] = 
            "8/8/8/8/8/8/8/8 w - - 0 1";
 
+bool fValidate = false;     // expensive board validation in debug builds
+
 /*
  *  BD class - the basic chess board
  */
@@ -66,26 +68,70 @@ void BD::Empty(void)  noexcept
     for (int cpc = 0; cpc < cpcMax; cpc++)
         for (int icp = 0; icp < icpMax; icp++)
             aicpbd[cpc][icp] = -1;
+    for (BB& bb : mpcpcbb)
+        bb.clear();
+    for (BB& bb : mpcptbb)
+        bb.clear();
+    for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc) {
+        mpcpcsqKing[cpc] = sqNil;
+        mpcpcevp[cpc] = EVP();
+        mpcpcevMaterial[cpc] = 0;
+    }
+    mk = 0;
+    phase = phaseMax;
 
     vmvuGame.clear();
     cmvNoCaptureOrPawn = 0;
 }
 
+/**
+ *  @fn         void VMVU::Fold(void)
+ *  @brief      Moves the recent move history into a new shared prefix
+ *
+ *  @details    Called when the fixed array of recent moves is full, and at the
+ *              start of a search so the search has the entire array to work
+ *              with. Other boards sharing the old prefix are not affected.
+ */
+
+void VMVU::Fold(void)
+{
+    if (cmvuRecent == 0)
+        return;
+    vector<MVU> vmvu;
+    vmvu.reserve(size());
+    if (pvmvuPrefix)
+        vmvu.insert(vmvu.end(), pvmvuPrefix->begin(), pvmvuPrefix->begin() + cmvuPrefix);
+    vmvu.insert(vmvu.end(), amvuRecent, amvuRecent + cmvuRecent);
+    cmvuPrefix = (uint32_t)vmvu.size();
+    cmvuRecent = 0;
+    pvmvuPrefix = make_shared<const vector<MVU>>(std::move(vmvu));
+}
+
 /**
  *  @fn         void BD::MakeMv(const MV& mv)
  *  @brief      Makes a move on the board
  * 
  *  @details    The board should be in a completely valid and consistent state 
  *              on exit. Maintains castle state, en passant state, the move 
- *              history, and the Zobrist hash. The move history will includes 
- *              everything necessary to undo a move.
+ *              history, the piece bitboards, and the Zobrist hash. The move 
+ *              history will includes everything necessary to undo a move.
  */
 
 void BD::MakeMv(const MV& mv) noexcept
 {
     assert(mv.sqFrom != sqNil && mv.sqTo != sqNil);
+    if (cpcToMove == cpcWhite)
+        MakeMv<cpcWhite>(mv);
+    else
+        MakeMv<cpcBlack>(mv);
+}
+
+template <CPC cpcMove>
+void BD::MakeMv(const MV& mv) noexcept
+{
+    assert(cpcMove == cpcToMove);
 
-    vmvuGame.emplace_back(mv, *this);
+    MVU& mvu = vmvuGame.emplace_back(mv, *this);
 
     CPBD cpbdMoveFrom = (*this)[mv.sqFrom];
     CPBD cpbdMoveTo = cpbdMoveFrom;
@@ -102,7 +148,7 @@ void BD::MakeMv(const MV& mv) noexcept
         else {
             /* handle en passant capture */
             if (mv.sqTo == sqEnPassant)
-                sqTake += cpcToMove == cpcWhite ? -8 : 8;
+                sqTake += cpcMove == cpcWhite ? -8 : 8;
             /* handle promotions */
             else if (mv.cptPromote != cptNone)
                 cpbdMoveTo.cpt = mv.cptPromote;
@@ -116,19 +162,20 @@ void BD::MakeMv(const MV& mv) noexcept
         sqEnPassant = sqNil;
         if (cpbdMoveFrom.cpt == cptRook) {
             /* clear castle state if we move a rook */
-            int raBack = RaBack(cpcToMove);
+            int raBack = RaBack(cpcMove);
             if (mv.sqFrom == Sq(fiQueenRook, raBack))
-                ClearCs(csQueen, cpcToMove);
+                ClearCs(csQueen, cpcMove);
             else if (mv.sqFrom == Sq(fiKingRook, raBack))
-                ClearCs(csKing, cpcToMove);
+                ClearCs(csKing, cpcMove);
         }
         else if (cpbdMoveFrom.cpt == cptKing) {
+            mpcpcsqKing[cpcMove] = mv.sqTo;
             /* after the king moves, no castling is allowed */
-            ClearCs(csKing|csQueen, cpcToMove);
+            ClearCs(csKing|csQueen, cpcMove);
             /* castle moves have the from/to of the king part of the move */
             /* Note Chess960 castle can potentially swap king and rook, so 
                order of emptying/placing is important */
-            int raBack = RaBack(cpcToMove);
+            int raBack = RaBack(cpcMove);
             int fiRookFrom, fiRookTo;
             if (mv.csMove & csQueen) {
                 fiRookFrom = fiQueenRook;
@@ -145,9 +192,10 @@ Castle:
                 (*this)[mv.sqFrom] = CPBD(cpEmpty, 0);
                 /* place the rook */
                 (*this)(fiRookTo, raBack) = cpbdRook;
-                aicpbd[cpcToMove][cpbdRook.icp] = IcpbdFromSq(fiRookTo, raBack);
+                aicpbd[cpcMove][cpbdRook.icp] = IcpbdFromSq(fiRookTo, raBack);
                 genha.TogglePiece(ha, Sq(fiRookTo, raBack), cpbdRook.cp());
                 genha.TogglePiece(ha, Sq(fiRookFrom, raBack), cpbdRook.cp());
+                MovePiece(Sq(fiRookFrom, raBack), Sq(fiRookTo, raBack), cpbdRook.cp());
                 /* go place the king */
                 goto PlaceMovePiece;
             }
@@ -159,16 +207,18 @@ Castle:
     if ((*this)[sqTake].cp() != cpEmpty) {
         cmvNoCaptureOrPawn = 0;
         CP cpTake = (*this)[sqTake].cp();
-        vmvuGame.back().cpTake = cpTake;
-        aicpbd[~cpcToMove][(*this)[sqTake].icp] = -1;
+        mvu.cpTake = cpTake;
+        mvu.icpTake = (*this)[sqTake].icp;
+        aicpbd[~cpcMove][(*this)[sqTake].icp] = -1;
         (*this)[sqTake] = CPBD(cpEmpty, 0);
         genha.TogglePiece(ha, sqTake, cpTake);
+        RemovePiece(sqTake, cpTake);
         /* when taking rooks, we may need to clear castle bits */
-        if (cpt(cpTake) == cptRook && ra(sqTake) == RaBack(~cpcToMove)) {
+        if (cpt(cpTake) == cptRook && ra(sqTake) == RaBack(~cpcMove)) {
             if (fi(sqTake) == fiQueenRook)
-                ClearCs(csQueen, ~cpcToMove);
+                ClearCs(csQueen, ~cpcMove);
             else if (fi(sqTake) == fiKingRook)
-                ClearCs(csKing, ~cpcToMove);
+                ClearCs(csKing, ~cpcMove);
         }
     }
 
@@ -177,12 +227,18 @@ Castle:
     (*this)[mv.sqFrom] = CPBD(cpEmpty, 0);
 PlaceMovePiece:
     (*this)[mv.sqTo] = cpbdMoveTo;
-    aicpbd[cpcToMove][cpbdMoveTo.icp] = IcpbdFromSq(mv.sqTo);
+    aicpbd[cpcMove][cpbdMoveTo.icp] = IcpbdFromSq(mv.sqTo);
     genha.TogglePiece(ha, mv.sqFrom, cpbdMoveFrom.cp());
     genha.TogglePiece(ha, mv.sqTo, cpbdMoveTo.cp());
+    if (cpbdMoveFrom.cpt == cpbdMoveTo.cpt)
+        MovePiece(mv.sqFrom, mv.sqTo, cpbdMoveTo.cp());
+    else {
+        RemovePiece(mv.sqFrom, cpbdMoveFrom.cp());
+        AddPiece(mv.sqTo, cpbdMoveTo.cp());
+    }
 
     genha.ToggleToMove(ha);
-    cpcToMove = ~cpcToMove;
+    cpcToMove = ~cpcMove;
     Validate();
 }
 
@@ -198,7 +254,7 @@ void BD::MakeMvNull(void) noexcept
 
 void BD::UndoMvNull(void) noexcept
 {
-    MVU mvu(vmvuGame.back());
+    const MVU& mvu = vmvuGame.back();
     assert(mvu.fIsNil());
     vmvuGame.pop_back();
 
@@ -215,64 +271,82 @@ void BD::UndoMvNull(void) noexcept
  * 
  *  @details    Uses the move history to restore the board to the state before 
  *              the last move was made. Includes restoring castle state, en 
- *              passant state, the move list, and the Zobrist hash.
+ *              passant state, the move list, the piece bitboards, and the 
+ *              Zobrist hash.
  */
 
+void BD::UndoMv(void) noexcept
+{
+    if (cpcToMove == cpcWhite)
+        UndoMv<cpcBlack>();
+    else
+        UndoMv<cpcWhite>();
+}
+
+template <CPC cpcMove>
 void BD::UndoMv(void) noexcept
 {
     int fiRookFrom, fiRookTo;
 
-    MVU mvu(vmvuGame.back());
+    const MVU& mvu = vmvuGame.back();   // pop_back leaves the storage alone
     vmvuGame.pop_back();
 
-    cpcToMove = ~cpcToMove;
+    cpcToMove = cpcMove;
     csCur = mvu.csSav;
     sqEnPassant = mvu.sqEnPassantSav;
     cmvNoCaptureOrPawn = mvu.cmvNoCaptureOrPawnSav;
     ha = mvu.haSav;
 
-    CPBD cpbdMove = (*this)[mvu.sqTo];
-    if (mvu.cptPromote != cptNone)
+    CPBD cpbdMove = (*this)[mvu.sqTo()];
+    if (cpbdMove.cpt == cptKing)
+        mpcpcsqKing[cpcMove] = mvu.sqFrom();
+    if (mvu.cptPromote() == cptNone)
+        MovePiece(mvu.sqTo(), mvu.sqFrom(), cpbdMove.cp());
+    else {
+        RemovePiece(mvu.sqTo(), cpbdMove.cp());
         cpbdMove.cpt = cptPawn;
+        AddPiece(mvu.sqFrom(), cpbdMove.cp());
+    }
 
     if (mvu.cpTake != cpEmpty) {
         /* undo captures */
-        int icpTake = IcpUnused(~cpcToMove, cpt(mvu.cpTake));
-        SQ sqTake = mvu.sqTo;
-        CPBD cpbdTake = CPBD(mvu.cpTake, icpTake);
-        if (mvu.sqTo == mvu.sqEnPassantSav) {
-            sqTake += cpcToMove == cpcWhite ? -8 : 8;
-            (*this)[mvu.sqTo] = CPBD(cpEmpty, 0);
+        SQ sqTake = mvu.sqTo();
+        CPBD cpbdTake = CPBD(mvu.cpTake, mvu.icpTake);
+        if (mvu.sqTo() == mvu.sqEnPassantSav) {
+            sqTake += cpcMove == cpcWhite ? -8 : 8;
+            (*this)[mvu.sqTo()] = CPBD(cpEmpty, 0);
         }
         (*this)[sqTake] = cpbdTake;
-        aicpbd[~cpcToMove][icpTake] = IcpbdFromSq(sqTake);
+        aicpbd[~cpcMove][mvu.icpTake] = IcpbdFromSq(sqTake);
+        AddPiece(sqTake, mvu.cpTake);
     }
-    else if (mvu.csMove & csKing) {
+    else if (mvu.csMove() & csKing) {
         /* undo king-side castle */
         fiRookFrom = fiKingRook;
         fiRookTo = fiF;
         goto UndoCastle;
     }
-    else if (mvu.csMove & csQueen) {
+    else if (mvu.csMove() & csQueen) {
         /* undo queen-side castle */
         fiRookFrom = fiQueenRook;
         fiRookTo = fiD;
 UndoCastle:
-        int raBack = RaBack(cpcToMove);
+        int raBack = RaBack(cpcMove);
         int icpRook = (*this)(fiRookTo, raBack).icp;
-        CPBD cpbdRook = acpbd[aicpbd[cpcToMove][icpRook]];
-        (*this)[mvu.sqTo] = CPBD(cpEmpty, 0);
+        CPBD cpbdRook = acpbd[aicpbd[cpcMove][icpRook]];
+        (*this)[mvu.sqTo()] = CPBD(cpEmpty, 0);
         (*this)(fiRookTo, raBack) = CPBD(cpEmpty, 0);
         (*this)(fiRookFrom, raBack) = cpbdRook;
-        aicpbd[cpcToMove][icpRook] = IcpbdFromSq(fiRookFrom, raBack);
+        aicpbd[cpcMove][icpRook] = IcpbdFromSq(fiRookFrom, raBack);
+        MovePiece(Sq(fiRookTo, raBack), Sq(fiRookFrom, raBack), cpbdRook.cp());
     }
     else {
         /* undo simple move */
-        (*this)[mvu.sqTo] = CPBD(cpEmpty, 0);
+        (*this)[mvu.sqTo()] = CPBD(cpEmpty, 0);
     }
 
-    (*this)[mvu.sqFrom] = cpbdMove;
-    aicpbd[cpcToMove][cpbdMove.icp] = IcpbdFromSq(mvu.sqFrom);
+    (*this)[mvu.sqFrom()] = cpbdMove;
+    aicpbd[cpcMove][cpbdMove.icp] = IcpbdFromSq(mvu.sqFrom());
 
     Validate();
 }
@@ -305,23 +379,16 @@ bool BD::FMakeMvLegal(const MV& mv) noexcept
 
 BB BD::BbPawns(CPC cpc) const noexcept
 {
-    BB bb;
-    for (int icp = 0; icp < 8; icp++) {
-        int icpbd = aicpbd[cpc][icp + 8];
-        if (icpbd == -1 || acpbd[icpbd].cpt != cptPawn)
-            continue;
-        bb |= SqFromIcpbd(icpbd);
-    }
-    return bb;
+    return BbPieces(cpc, cptPawn);
 }
 
 /**
  *  @fn         BB BD::BbAttacked(CPC cpc) const
- *  @brief      Returns a bitboard with all squares with an implied attack
- *              by the color cpc
+ *  @brief      Returns a bitboard with all squares attacked by the color cpc
  * 
- *  @details    An implied attack means the piece can see through other
- *              pieces, but pawns are blockers. Used for estimating King
+ *  @details    Squares occupied by pieces of either color are included if 
+ *              they are attacked, and pawns attack diagonally whether or not
+ *              there is anything to capture there. Used for estimating King
  *              safety.
  * 
  *  TODO: what we really want is probably a count of pieces that attack the
@@ -330,18 +397,18 @@ BB BD::BbPawns(CPC cpc) const noexcept
  *  that is the most dangerous situation.
  */
 
-BB BD::BbAttacked(CPC cpc) noexcept
+BB BD::BbAttacked(CPC cpc) const noexcept
 {
-    /* TODO: do a real implementation once we have bitboards */
-    VMV vmv;
-    if (cpc == cpcToMove)
-        MoveGenPseudo(vmv);
-    else {
-        MakeMvNull();
-        MoveGenPseudo(vmv);
-        UndoMvNull();
-    }
-    return BbAttackedFromVmv(vmv);
+    BB bbOccupied = BbOccupied();
+    BB bbAttacked = BbPawnAttacks(BbPieces(cpc, cptPawn), cpc);
+    for (BB bb = BbPieces(cpc, cptKnight); bb; bb.ClearLow())
+        bbAttacked |= mpbb.BbKnightTo(bb.sqLow());
+    for (BB bb = BbPieces(cpc, cptBishop) | BbPieces(cpc, cptQueen); bb; bb.ClearLow())
+        bbAttacked |= mpbb.BbBishopAttacks(bb.sqLow(), bbOccupied);
+    for (BB bb = BbPieces(cpc, cptRook) | BbPieces(cpc, cptQueen); bb; bb.ClearLow())
+        bbAttacked |= mpbb.BbRookAttacks(bb.sqLow(), bbOccupied);
+    bbAttacked |= mpbb.BbKingTo(SqKing(cpc));
+    return bbAttacked;
 }
 
 BB BD::BbAttackedFromVmv(const VMV& vmv) const noexcept
@@ -362,15 +429,6 @@ const int mpcptphase[cptMax] = { 0, 0, phaseMinor, phaseMinor, phaseRook, phaseQ
 
 int BD::PhaseCur(void) const noexcept
 {
-    int phase = phaseMax;
-    for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc) {
-        for (int icp = 0; icp < icpMax; ++icp) {
-            int icpbd = aicpbd[cpc][icp];
-            if (icpbd == -1)
-                continue;
-            phase -= mpcptphase[acpbd[icpbd].cpt];
-        }
-    }
     return max(phase, phaseMin);
 }
 
@@ -387,7 +445,7 @@ bool BD::FGameDrawn(int cbd) const noexcept
 
 bool BD::FDrawRepeat(int cbdDraw) const noexcept
 {
-    if (cmvNoCaptureOrPawn < (cbdDraw - 1) * 2 * 2)
+    if (cmvNoCaptureOrPawn < (cbdDraw - 1) * 2 * 2 || !vmvuGame.FMayContain(ha))
         return false;
     int cbdSame = 1;
     int imvLastCaptureOrPawn = (int)vmvuGame.size() - cmvNoCaptureOrPawn;
@@ -401,76 +459,106 @@ bool BD::FDrawRepeat(int cbdDraw) const noexcept
     return false;
 }
 
+/**
+ *  @fn         bool BD::FUpcomingRepeat(int d) const
+ *  @brief      Checks if the side to move can repeat a position with one
+ *              reversible move
+ * 
+ *  @details    If we can move back into a position that already occurred 
+ *              inside the search tree, we can force a draw, so the draw is 
+ *              a lower bound on this node. This lets the search score the 
+ *              repetition one ply sooner than FDrawRepeat does.
+ * 
+ *              We walk back two plies at a time, keeping track of the net 
+ *              change in the hash from the opponent's moves. Only when the 
+ *              opponent's pieces are back where they were does the hash
+ *              difference to that position have a chance of being one of 
+ *              our moves, which we look up in the cuckoo table. The squares 
+ *              between the move's from and to have to be empty. We stop at 
+ *              null moves, since the hash history is broken there. Positions
+ *              from before the root of the search, which d tells us about, 
+ *              aren't considered.
+ */
+
+bool BD::FUpcomingRepeat(int d) const noexcept
+{
+    int imvuMac = (int)vmvuGame.size();
+    int cmvBack = min({ (int)cmvNoCaptureOrPawn, imvuMac, d - 1 });
+    if (cmvBack < 3 || vmvuGame[imvuMac - 1].fIsNil())
+        return false;
+
+    HA haOther = ha ^ vmvuGame[imvuMac - 1].haSav ^ GENHA::HaToMove();
+    for (int imvBack = 3; imvBack <= cmvBack; imvBack += 2) {
+        const MVU& mvuOther = vmvuGame[imvuMac - imvBack + 1];
+        const MVU& mvuSelf = vmvuGame[imvuMac - imvBack];
+        if (mvuOther.fIsNil() || mvuSelf.fIsNil())
+            return false;
+        haOther ^= mvuOther.haSav ^ mvuSelf.haSav ^ GENHA::HaToMove();
+        if (haOther != 0)
+            continue;
+        MVC mvc;
+        if (cuckoo.FLookup(ha ^ mvuSelf.haSav, mvc) && 
+                !(mpbb.BbBetween(mvc.sqFrom(), mvc.sqTo()) & BbOccupied()))
+            return true;
+    }
+    return false;
+}
+
 /**
  *  @fn bool BD::FDrawDead(void) const noexcept
  *  @brief If we're in a dead draw position
  * 
  *  Returns true if we're in a board state where no one can force checkmate 
- *  on the other player.
+ *  on the other player. Any pawn, rook, or queen means play on. Otherwise
+ *  the answer comes out of a small table indexed by the minor piece counts 
+ *  in the material key.
  */
 
-bool BD::FDrawDead(void) const noexcept
-{
-    int acpcMinor[2] = { 0 };;
-    for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc) {
-        for (int icp = 0; icp < icpMax; ++icp) {
-            int icpbd = aicpbd[cpc][icp];
-            if (icpbd == -1 || acpbd[icpbd].cpt == cptKing)
-                continue;
-            if (acpbd[icpbd].cpt == cptPawn || acpbd[icpbd].cpt == cptRook ||
-                    acpbd[icpbd].cpt == cptQueen)
-                return false;
-            acpcMinor[acpbd[icpbd].cpc]++;
-        }
-    }
-    
-    /* from here on, there are only bishops, knights, and kings on the board */
+constexpr MK mkHeavy = MkFromCp(cpWhitePawn, 0x0f) | MkFromCp(cpBlackPawn, 0x0f) |
+                       MkFromCp(cpWhiteRook, 0x0f) | MkFromCp(cpBlackRook, 0x0f) |
+                       MkFromCp(cpWhiteQueen, 0x0f) | MkFromCp(cpBlackQueen, 0x0f);
 
-    /* mutiple pieces, keep playing */
-    if (acpcMinor[cpcWhite] > 1 || acpcMinor[cpcBlack] > 1)
-        return false;
+/* minor piece counts, clamped to 3, packed 2 bits each into an index */
 
-    /* this handles K vs. K, K-N vs. K, or K-B vs. K */
-    if (acpcMinor[cpcWhite] == 0 || acpcMinor[cpcBlack] == 0)
-        return true;
+constexpr int IMinorFromMk(MK mk) noexcept
+{
+    return min(CcpFromMk(mk, cpWhiteKnight), 3) | 
+           (min(CcpFromMk(mk, cpWhiteBishop), 3) << 2) |
+           (min(CcpFromMk(mk, cpBlackKnight), 3) << 4) |
+           (min(CcpFromMk(mk, cpBlackBishop), 3) << 6);
+}
 
-    /* TODO: matching color bishops case */
+/* K vs. K, K-N vs. K, or K-B vs. K; TODO: matching color bishops case */
 
-    return false;
+static constexpr array<bool, 256> mpiminorfDead = []() {
+    array<bool, 256> mpiminorf = {};
+    for (int iminor = 0; iminor < 256; iminor++) {
+        int ccpWhite = (iminor & 3) + ((iminor >> 2) & 3);
+        int ccpBlack = ((iminor >> 4) & 3) + ((iminor >> 6) & 3);
+        mpiminorf[iminor] = ccpWhite <= 1 && ccpBlack <= 1 && (ccpWhite == 0 || ccpBlack == 0);
+    }
+    return mpiminorf;
+}();
+
+bool BD::FDrawDead(void) const noexcept
+{
+    if (mk & mkHeavy)
+        return false;
+    return mpiminorfDead[IMinorFromMk(mk)];
 }
 
 bool BD::FSufficientMaterial(CPC cpc) const noexcept
 {
-    int cpcMinor = 0;
-    for (int icp = 0; icp < icpMax; icp++) {
-        int icpbd = aicpbd[cpc][icp];
-        if (icpbd == -1)
-            continue;
-        switch (acpbd[icpbd].cpt) {
-        case cptKing:
-            break;
-        case cptPawn:
-        case cptRook:
-        case cptQueen:
-            return true;
-        default:
-            cpcMinor++;
-            break;
-        }
-    }
-    return cpcMinor > 1;
+    if (CcpFromMk(mk, Cp(cpc, cptPawn)) | CcpFromMk(mk, Cp(cpc, cptRook)) | CcpFromMk(mk, Cp(cpc, cptQueen)))
+        return true;
+    return CcpFromMk(mk, Cp(cpc, cptKnight)) + CcpFromMk(mk, Cp(cpc, cptBishop)) > 1;
 }
 
+const EV mpcptevMaterial[cptMax] = { 0, 100, 300, 300, 500, 900, 250 };
+
 EV BD::EvMaterial(CPC cpc) const noexcept
 {
-    static EV mpcptev[cptMax] = { 0, 100, 300, 300, 500, 900, 250 };
-    EV ev = 0;
-    for (int icp = 0; icp < icpMax; ++icp) {
-        int icpbd = aicpbd[cpc][icp];
-        if (icpbd != -1)
-            ev += mpcptev[acpbd[icpbd].cpt];
-    }
-    return ev;
+    return mpcpcevMaterial[cpc];
 }
 
 /*
@@ -505,6 +593,39 @@ void BD::Validate(void) const noexcept
         assert(IcpbdFromSq(sq) == aicpbd[cpc][icp]);
     }
 
+    /* check bitboards match the mailbox */
+
+    for (SQ sq = 0; sq < sqMax; sq++) {
+        CPBD cpbd = (*this)[sq];
+        for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc)
+            assert(!!(mpcpcbb[cpc] & sq) == (cpbd.cpc == cpc));
+        for (CPT cpt = cptPawn; cpt < cptMax; ++cpt)
+            assert(!!(mpcptbb[cpt] & sq) == (cpbd.cp() != cpEmpty && cpbd.cpt == cpt));
+    }
+    for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc)
+        assert(!BbPieces(cpc, cptKing) || mpcpcsqKing[cpc] == BbPieces(cpc, cptKing).sqLow());
+
+    /* check the running evaluation totals */
+
+    EVP mpcpcevpT[cpcMax];
+    EV mpcpcevMaterialT[cpcMax] = { 0, 0 };
+    int phaseT = phaseMax;
+    for (SQ sq = 0; sq < sqMax; sq++) {
+        CPBD cpbd = (*this)[sq];
+        if (cpbd.cp() == cpEmpty)
+            continue;
+        mpcpcevpT[cpbd.cpc] += mpcpsqevp[cpbd.cp()][sq];
+        mpcpcevMaterialT[cpbd.cpc] += mpcptevMaterial[cpbd.cpt];
+        phaseT -= mpcptphase[cpbd.cpt];
+    }
+    for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc) {
+        assert(mpcpcevp[cpc] == mpcpcevpT[cpc]);
+        assert(mpcpcevMaterial[cpc] == mpcpcevMaterialT[cpc]);
+        for (CPT cpt = cptPawn; cpt < cptMax; ++cpt)
+            assert(CcpFromMk(mk, Cp(cpc, cpt)) == BbPieces(cpc, cpt).csq());
+    }
+    assert(phase == phaseT);
+
     // assert(ha == genha.HaFromBd(*this));
 }
 #endif
@@ -513,52 +634,7 @@ void BD::Validate(void) const noexcept
  *  Zobrist hash generation
  */
 
-GENHA genha;    // generate this at startup 
- 
-HA GENHA::ahaPiece[sqMax][cpMax];
-HA GENHA::ahaCastle[16];
-HA GENHA::ahaEnPassant[8];
-HA GENHA::haToMove;
-
-/**
- *  @fn GENHA::GENHA(void)
- *  @brief Generates the random bit arrays used to compute the Zobrist hash.
- */
-
-GENHA::GENHA(void)
-{
-    /* WARNING! - the order of these initializations is critical to making 
-       Polyglot lookup work. These loops are carefully ordered. Don't change 
-       it! */
-
-    ahaPiece[0][0] = 0;
-    for (CPT cpt = cptPawn; cpt <= cptKing; ++cpt)
-        for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc)
-            for (int ra = 0; ra < raMax; ra++)
-                for (int fi = 0; fi < fiMax; fi++)
-                    ahaPiece[Sq(fi,ra)][Cp(~cpc,cpt)] = HaRandom();
-
-    HA haWhiteKing = HaRandom();
-    HA haWhiteQueen = HaRandom();
-    HA haBlackKing = HaRandom();
-    HA haBlackQueen = HaRandom();
-    for (int cs = 0; cs < size(ahaCastle); cs++) {
-        ahaCastle[cs] = 0;
-        if (cs & csWhiteKing)
-            ahaCastle[cs] ^= haWhiteKing;
-        if (cs & csWhiteQueen)
-            ahaCastle[cs] ^= haWhiteQueen;
-        if (cs & csBlackKing)
-            ahaCastle[cs] ^= haBlackKing;
-        if (cs & csBlackQueen)
-            ahaCastle[cs] ^= haBlackQueen;
-    }
-
-    for (int fi = 0; fi < fiMax; fi++)
-        ahaEnPassant[fi] = HaRandom();
-
-    haToMove = HaRandom();
-}
+GENHA genha;
 
 /**
  *  @fn HA GENHA::HaFromBd(const BD&  bd) const
@@ -634,20 +710,15 @@ bool GENHA::FEnPassantPolyglot(const BD& bd) const
     return false;
 }
 
-MPBB mpbb;
-
-/**
- *  @fn         MPBB::MPBB(void)
- *  @brief      Creates handy bitboards
+/*
+ *  The fixed bitboard tables, all generated at compile time
  */
 
-MPBB::MPBB(void)
+static constexpr array<array<BB, 8>, 64> MpsqdirbbSlideInit(void) noexcept
 {
+    array<array<BB, 8>, 64> mpsqdirbb = {};
     for (int ra = 0; ra < raMax; ra++)
-        for (int fi = 0; fi < fiMax; fi++) {
-            SQ sq = Sq(fi, ra);
-
-            /* slides */
+        for (int fi = 0; fi < fiMax; fi++)
             for (int dra = -1; dra <= 1; dra++)
                 for (int dfi = -1; dfi <= 1; dfi++) {
                     if (dra == 0 && dfi == 0)
@@ -655,33 +726,269 @@ MPBB::MPBB(void)
                     DIR dir = DirFromDraDfi(dra, dfi);
                     for (int raMove = ra + dra, fiMove = fi + dfi;
                          ((raMove | fiMove) & ~7) == 0; raMove += dra, fiMove += dfi)
-                        mpsqdirbbSlide[sq][(int)dir] |= BB(Sq(fiMove, raMove));
+                        mpsqdirbb[Sq(fi, ra)][dir] |= BB(Sq(fiMove, raMove));
                 }
+    return mpsqdirbb;
+}
+
+constinit const array<array<BB, 8>, 64> MPBB::mpsqdirbbSlide = MpsqdirbbSlideInit();
+
+constinit const array<BB, 64> MPBB::mpsqbbKnight = []() {
+    array<BB, 64> mpsqbb = {};
+    for (SQ sq = 0; sq < sqMax; sq++) {
+        BB bb(sq);
+        BB bb1 = BbWest1(bb) | BbEast1(bb);
+        BB bb2 = BbWest2(bb) | BbEast2(bb);
+        mpsqbb[sq] = BbNorth2(bb1) | BbSouth2(bb1) | BbNorth1(bb2) | BbSouth1(bb2);
+    }
+    return mpsqbb;
+}();
+
+constinit const array<BB, 64> MPBB::mpsqbbKing = []() {
+    array<BB, 64> mpsqbb = {};
+    for (SQ sq = 0; sq < sqMax; sq++) {
+        BB bb(sq);
+        BB bb1 = BbEast1(bb) | BbWest1(bb);
+        mpsqbb[sq] = bb1 | BbNorth1(bb1 | bb) | BbSouth1(bb1 | bb);
+    }
+    return mpsqbb;
+}();
+
+/* passed pawn alleys, only for squares a pawn can be on */
+
+constinit const array<array<BB, 2>, 48> MPBB::mpsqbbPassedPawnAlley = []() {
+    array<array<BB, 8>, 64> mpsqdirbbSlide = MpsqdirbbSlideInit();
+    array<array<BB, 2>, 48> mpsqbb = {};
+    for (SQ sq = 8; sq < sqMax - 8; sq++) {
+        BB bbNorth = mpsqdirbbSlide[sq][dirNorth];
+        BB bbSouth = mpsqdirbbSlide[sq][dirSouth];
+        mpsqbb[sq - 8][cpcWhite] = bbNorth | BbEast1(bbNorth) | BbWest1(bbNorth);
+        mpsqbb[sq - 8][cpcBlack] = bbSouth | BbEast1(bbSouth) | BbWest1(bbSouth);
+    }
+    return mpsqbb;
+}();
+
+/* king attack neighborhoods */
+
+constinit const array<BB, 64> MPBB::mpsqbbKingAttackInner = []() {
+    array<BB, 64> mpsqbb = {};
+    for (SQ sq = 0; sq < sqMax; sq++) {
+        BB bbKing = BB(sq);
+        BB bbT = BbNorth1(bbKing) | bbKing | BbSouth1(bbKing);
+        mpsqbb[sq] = bbT | BbEast1(bbT) | BbWest1(bbT);
+    }
+    return mpsqbb;
+}();
+
+constinit const array<BB, 64> MPBB::mpsqbbKingAttackOuter = []() {
+    array<BB, 64> mpsqbb = {};
+    for (SQ sq = 0; sq < sqMax; sq++) {
+        BB bbKing = BB(sq);
+        BB bbT = BbNorth1(bbKing) | bbKing | BbSouth1(bbKing);
+        BB bbInner = bbT | BbEast1(bbT) | BbWest1(bbT);
+        bbT = BbNorth1(bbInner) | BbSouth1(bbInner);
+        mpsqbb[sq] = (BbEast1(bbT) | BbWest1(bbT)) - bbInner;
+    }
+    return mpsqbb;
+}();
+
+/* lines and the squares in between; these are empty for squares that
+   aren't on a common rank, file, or diagonal */
+
+constinit const array<array<BB, 64>, 64> MPBB::mpsqsqbbBetween = []() {
+    array<array<BB, 8>, 64> mpsqdirbbSlide = MpsqdirbbSlideInit();
+    array<array<BB, 64>, 64> mpsqsqbb = {};
+    for (SQ sq1 = 0; sq1 < sqMax; sq1++)
+        for (DIR dir = dirMin; dir < dirMax; ++dir)
+            for (SQ sq2 = 0; sq2 < sqMax; sq2++)
+                if (mpsqdirbbSlide[sq1][dir] & sq2)
+                    mpsqsqbb[sq1][sq2] = mpsqdirbbSlide[sq1][dir] - mpsqdirbbSlide[sq2][dir] - BB(sq2);
+    return mpsqsqbb;
+}();
+
+constinit const array<array<BB, 64>, 64> MPBB::mpsqsqbbLine = []() {
+    array<array<BB, 8>, 64> mpsqdirbbSlide = MpsqdirbbSlideInit();
+    array<array<BB, 64>, 64> mpsqsqbb = {};
+    for (SQ sq1 = 0; sq1 < sqMax; sq1++)
+        for (DIR dir = dirMin; dir < dirMax; ++dir)
+            for (SQ sq2 = 0; sq2 < sqMax; sq2++)
+                if (mpsqdirbbSlide[sq1][dir] & sq2)
+                    mpsqsqbb[sq1][sq2] = mpsqdirbbSlide[sq1][dir] | mpsqdirbbSlide[sq1][DirReverse(dir)] | BB(sq1);
+    return mpsqsqbb;
+}();
+
+MPBB mpbb;
+
+/**
+ *  @fn         MPBB::MPBB(void)
+ *  @brief      Builds the slider attack tables
+ * 
+ *  @details    Everything else in MPBB is built at compile time.
+ */
+
+MPBB::MPBB(void)
+{
+    static const DIR adirBishop[4] = { dirSouthWest, dirSouthEast, dirNorthWest, dirNorthEast };
+    static const DIR adirRook[4] = { dirSouth, dirWest, dirEast, dirNorth };
+    InitMagics(mpsqmagicBishop, abbBishopAttacks, adirBishop);
+    InitMagics(mpsqmagicRook, abbRookAttacks, adirRook);
+}
 
-            /* knights */
-            BB bb(sq);
-            BB bb1 = BbWest1(bb) | BbEast1(bb);
-            BB bb2 = BbWest2(bb) | BbEast2(bb);
-            mpsqbbKnight[sq] = BbNorth2(bb1) | BbSouth2(bb1) | BbNorth1(bb2) | BbSouth1(bb2);
-
-            /* kings */
-            bb1 = BbEast1(bb) | BbWest1(bb);
-            mpsqbbKing[sq] = bb1 | BbNorth1(bb1 | bb) | BbSouth1(bb1 | bb);
-
-            /* passed pawn alleys */
-            if (FInRange(ra, 1, raMax - 2)) {
-                BB bbNorth = mpsqdirbbSlide[sq][dirNorth];
-                BB bbSouth = mpsqdirbbSlide[sq][dirSouth];
-                mpsqbbPassedPawnAlley[sq - 8][cpcWhite] = bbNorth | BbEast1(bbNorth) | BbWest1(bbNorth);
-                mpsqbbPassedPawnAlley[sq - 8][cpcBlack] = bbSouth | BbEast1(bbSouth) | BbWest1(bbSouth);
+/**
+ *  @fn         BB MPBB::BbSlideAttacks(SQ sq, DIR dir, BB bbOccupied) const
+ *  @brief      Squares attacked by a slider in one direction
+ * 
+ *  @details    The attack ray stops at the first occupied square, which is
+ *              included in the result. Forward directions find the blocker
+ *              with the lowest bit, reverse directions with the highest. 
+ *              This is only used to build the magic attack tables.
+ */
+
+BB MPBB::BbSlideAttacks(SQ sq, DIR dir, BB bbOccupied) const noexcept
+{
+    BB bbSlide = mpsqdirbbSlide[sq][dir];
+    BB bbBlockers = bbSlide & bbOccupied;
+    if (bbBlockers) {
+        SQ sqBlocker = dir >= dirEast ? bbBlockers.sqLow() : bbBlockers.sqHigh();
+        bbSlide -= mpsqdirbbSlide[sqBlocker][dir];
+    }
+    return bbSlide;
+}
+
+/**
+ *  @fn         void MPBB::InitMagics(MAGIC mpsqmagic[], BB abbAttacks[], const DIR adir[4])
+ *  @brief      Builds the slider attack tables for one type of slider
+ * 
+ *  @details    For each square, enumerates every subset of the blocker mask
+ *              and stores the attacks in the square's section of the shared
+ *              table. With PEXT, the index is just the extracted blocker 
+ *              bits. Without it, we search for a magic multiplier that maps
+ *              every subset to a slot without a destructive collision. The
+ *              random number generator is reseeded on each rank with seeds
+ *              picked offline to keep the search short, so we get the same 
+ *              magics, and the same startup time, on every run.
+ */
+
+void MPBB::InitMagics(MAGIC mpsqmagic[], BB abbAttacks[], const DIR adir[4]) noexcept
+{
+    /* random number seeds for each rank that find magics quickly */
+    static const unsigned mpraseed[raMax] = { 268, 281, 207, 188, 256, 107, 11, 50 };
+    mt19937_64 rand;
+    vector<BB> vbbOccupied(4096), vbbAttacks(4096);
+    vector<int> vepoch(4096, 0);
+    int epoch = 0;
+    BB* pbbAttacks = abbAttacks;
+
+    for (SQ sq = 0; sq < sqMax; sq++) {
+        MAGIC& magic = mpsqmagic[sq];
+        if (fi(sq) == 0)
+            rand.seed(mpraseed[ra(sq)]);
+
+        /* the blocker mask is the slides without the last square on the 
+           ray, because a piece on the edge blocks nothing */
+        magic.bbMask = BB();
+        for (int idir = 0; idir < 4; idir++) {
+            BB bbSlide = mpsqdirbbSlide[sq][adir[idir]];
+            if (bbSlide)
+                magic.bbMask |= bbSlide - BB(adir[idir] >= dirEast ? bbSlide.sqHigh() : bbSlide.sqLow());
+        }
+        int csq = magic.bbMask.csq();
+        magic.shift = 64 - csq;
+        magic.pbbAttacks = pbbAttacks;
+        magic.grfMagic = 0;
+
+        /* enumerate all subsets of the mask (the Carry-Rippler trick) */
+        int cbb = 0;
+        BB bbOccupied;
+        do {
+            vbbOccupied[cbb] = bbOccupied;
+            vbbAttacks[cbb] = BB();
+            for (int idir = 0; idir < 4; idir++)
+                vbbAttacks[cbb] |= BbSlideAttacks(sq, adir[idir], bbOccupied);
+            cbb++;
+            bbOccupied = BB((bbOccupied.grf - magic.bbMask.grf) & magic.bbMask.grf);
+        } while (bbOccupied);
+
+        if (MAGIC::FPext()) {
+            for (int ibb = 0; ibb < cbb; ibb++)
+                magic.pbbAttacks[magic.Index(vbbOccupied[ibb])] = vbbAttacks[ibb];
+        }
+        else {
+            for (bool fFound = false; !fFound; ) {
+                magic.grfMagic = rand() & rand() & rand();
+                if (CsqPopcount((magic.bbMask.grf * magic.grfMagic) >> 56) < 6)
+                    continue;
+                epoch++;
+                fFound = true;
+                for (int ibb = 0; ibb < cbb; ibb++) {
+                    unsigned ibbTable = magic.Index(vbbOccupied[ibb]);
+                    if (vepoch[ibbTable] < epoch) {
+                        vepoch[ibbTable] = epoch;
+                        magic.pbbAttacks[ibbTable] = vbbAttacks[ibb];
+                    }
+                    else if (magic.pbbAttacks[ibbTable] != vbbAttacks[ibb]) {
+                        fFound = false;
+                        break;
+                    }
+                }
             }
+        }
+
+        pbbAttacks += cbb;
+    }
+}
+
+/*
+ *  Cuckoo table for upcoming repetition detection
+ */
 
-            /* king attack neighborhoods */
-            BB bbKing = BB(sq);
-            BB bbT = BbNorth1(bbKing) | bbKing | BbSouth1(bbKing);
-            BB bbInner = bbT | BbEast1(bbT) | BbWest1(bbT);
-            bbT = BbNorth1(bbInner) | BbSouth1(bbInner);
-            mpsqbbKingAttackInner[sq] = bbInner;
-            mpsqbbKingAttackOuter[sq] = (BbEast1(bbT) | BbWest1(bbT)) - bbInner;
+CUCKOO cuckoo;  // needs genha and mpbb, so it must come after them
+
+/**
+ *  @fn         CUCKOO::CUCKOO(void)
+ *  @brief      Builds the table of reversible move hashes
+ * 
+ *  @details    Standard cuckoo insertion: if the slot is taken, we evict the 
+ *              entry that's there and move it to its other slot, and so on 
+ *              until we land in an empty slot. The table is less than half
+ *              full, so this always settles down quickly.
+ */
+
+CUCKOO::CUCKOO(void)
+{
+    fill(begin(ahaMove), end(ahaMove), 0);
+    fill(begin(amvc), end(amvc), MVC());
+
+    int cmv = 0;
+    for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc)
+        for (CPT cpt = cptKnight; cpt <= cptKing; ++cpt) {
+            CP cp = Cp(cpc, cpt);
+            for (SQ sq1 = 0; sq1 < sqMax; sq1++) {
+                BB bbTo;
+                switch (cpt) {
+                case cptKnight: bbTo = mpbb.BbKnightTo(sq1); break;
+                case cptBishop: bbTo = mpbb.BbBishopAttacks(sq1, BB()); break;
+                case cptRook: bbTo = mpbb.BbRookAttacks(sq1, BB()); break;
+                case cptQueen: bbTo = mpbb.BbQueenAttacks(sq1, BB()); break;
+                default: bbTo = mpbb.BbKingTo(sq1); break;
+                }
+                for (; bbTo; bbTo.ClearLow()) {
+                    SQ sq2 = bbTo.sqLow();
+                    if (sq2 < sq1)
+                        continue;
+                    HA haMove = GENHA::HaPiece(sq1, cp) ^ GENHA::HaPiece(sq2, cp) ^ GENHA::HaToMove();
+                    MVC mvc(sq1, sq2);
+                    int iha = Iha1(haMove);
+                    while (true) {
+                        swap(ahaMove[iha], haMove);
+                        swap(amvc[iha], mvc);
+                        if (mvc.fIsNil())
+                            break;
+                        iha = iha == Iha1(haMove) ? Iha2(haMove) : Iha1(haMove);
+                    }
+                    cmv++;
+                }
+            }
         }
+    assert(cmv == 3668);
 }
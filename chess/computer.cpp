@@ -15,9 +15,71 @@
 #include "chess.h"
 #include "computer.h"
 
+#ifndef CONSOLE
 WNLOG* pwnlog = nullptr;  // logging
+#else
+LOGCON logcon;
+LOGCON* pwnlog = &logcon;   // logging
+#endif
 SETAI setaiDefault;     // default AI settings
 
+#ifdef CONSOLE
+
+/**
+ *  @class      LOGCON
+ *  @brief      Console logging
+ * 
+ *  @details    The headless build logs through this stream instead of the 
+ *              log window. Nothing is logged until an output stream is 
+ *              set with SetOutput.
+ */
+
+LOGCON::LOGCON(void) :
+    ostream(&sb),
+    sb(*this)
+{
+}
+
+void LOGCON::SetOutput(ostream* posNew)
+{
+    posOut = posNew;
+}
+
+void LOGCON::ReceiveStream(int level, const string& s)
+{
+    if (posOut == nullptr || level > levelLog)
+        return;
+    *posOut << string(4*level, ' ') << s << endl;
+}
+
+logconbuf::logconbuf(LOGCON& logcon) :
+    logcon(logcon)
+{
+}
+
+logconbuf::int_type logconbuf::overflow(int_type ch)
+{
+    if (ch == traits_type::eof())
+        return ch;
+    if (ch == '\n') {
+        logcon.ReceiveStream(logcon.get_level(), buffer);
+        buffer.clear();
+    }
+    else {
+        buffer.push_back(static_cast<char>(ch));
+    }
+    return ch;
+}
+
+#endif // CONSOLE
+
+#ifndef CONSOLE
+
+/*
+ *  The players only exist in the graphical app. The headless console build
+ *  drives the AI directly.
+ */
+
 PL::PL(void)
 {
 }
@@ -60,12 +122,18 @@ void PLAI::Interrupt(WAPP& wapp, GAME& game)
     fInterruptSearch = true;
 }
 
+#endif // CONSOLE
+
 AI::AI(const SETAI& set) :
+    pmpcpsqhtCont1(make_unique<MPCPSQHT>()),
+    pmpcpsqhtCont2(make_unique<MPCPSQHT>()),
     set(set)
 {
     xt.SetSize(set.cmbXt);
 }
 
+#ifndef CONSOLE
+
 /**
  *  @fn         MV AI::MvBestTest(WAPP& wapp, GAME& game, const TMAN& tman)
  *  @brief      Stub entry pont for testing the AI
@@ -80,6 +148,8 @@ MV AI::MvBestTest(WAPP& wapp, GAME& game, const TMAN& tman)
     return MvBest(game.bd, tman);
 }
 
+#endif // CONSOLE
+
 /**
  *  @class      BRK
  *  @brief      Helper class for debugging and logging
@@ -174,7 +244,7 @@ private:
     int dMatch = -1;  // the last depth we matched in the breakpoint array
 };
 
-BRK brk;
+BRK brkSearch;
 
 /**
  *  @fn         MV AI::MvBest(BD& bdGame, const TMAN& tman)
@@ -201,55 +271,61 @@ MV AI::MvBest(BD& bdGame, const TMAN& tman) noexcept
 
     /* prepare for search */
     stat.Init();
-    InitPsts();
     xt.Init();
     InitKillers();
     InitHistory();
     InitTimeMan(bdGame, tman);
-    brk.Init();
+    brkSearch.Init();
+    pvBestAll.clear();
     fInterruptSearch = false;
 
-    /* generate all possible legal moves - we don't bother with pseudo moves
-       here since we know we will be checking every move at least once */
+    /* generate all possible legal moves */
     BD bd(bdGame);
+    bd.vmvuGame.Fold();
     VMV vmv;
     bd.MoveGen(vmv);
     stat.cmvMoveGen += vmv.size();
     
     MV mvBestAll(vmv[0]), mvBest;
-    /* UCI depth takes precedene over engine settings */
-    dSearchMax = tman.odMax.has_value() ? tman.odMax.value() : set.dMax;
     int dLim = 2;
     AB abInit(AbInfinite());
     HD mpdhd[dMax];
     mpdhd[0].evStatic = EvStatic(bd);
+    mpdhd[0].fFollowPv = true;
+    InitContinuation(bd, mpdhd, 0);
 
     do {    /* iterative deepening/aspiration window loop */
         stat.cmvSearch++;
         mvBest.ev = -evInfinity;
-        brk.LogDepth(dLim, abInit, "depth");
+        dLimRoot = dLim;
+        brkSearch.LogDepth(dLim, abInit, "depth");
         AB ab = abInit;
-        for (VMV::siterator pmv = vmv.InitMv(bd, *this); vmv.FGetMv(pmv, bd); vmv.NextMv(pmv)) {
-            brk.Check(0, *pmv);
-            brk.LogMvStart(*pmv, ab);
+        mpdhd[0].pv.clear();
+        mpdhd[0].mvcPv = pvBestAll.size() > 0 ? pvBestAll[0] : MVC();
+        for (VMV::siterator pmv = vmv.InitMv(bd, *this, &mpdhd[0]); vmv.FGetMv(pmv, bd); vmv.NextMv(pmv)) {
+            brkSearch.Check(0, *pmv);
+            brkSearch.LogMvStart(*pmv, ab);
             pmv->ev = -EvSearchPv(bd, -ab, 0+1, dLim, mpdhd, soNormal);
             bd.UndoMv();
+            EV evAlpha = ab.evAlpha;
             if (FPrune(ab, *pmv, mvBest, dSearchMax)) {
                 SaveCut(bd, *pmv, ab, 0, dLim);
                 dLim = min(dLim, dMax);
                 break;
             }
-            brk.LogMvEnd(*pmv);
+            if (ab.evAlpha > evAlpha)
+                mpdhd[0].pv.Set(*pmv, mpdhd[1].pv);
+            brkSearch.LogMvEnd(*pmv);
         }
     
         if (FEvIsInterrupt(mvBest.ev)) {
-            brk.LogDepthEnd(mvBest, "interrupt");
+            brkSearch.LogDepthEnd(mvBest, "interrupt");
             break;
         }
         if (mvBest.ev > -evInfinity)
             SaveXt(bd, mvBest, abInit, 0, dLim);
-        brk.LogDepthEnd(mvBest, "best");    
-    } while (FDeepen(bd, mvBestAll, mvBest, abInit, dLim) &&
+        brkSearch.LogDepthEnd(mvBest, "best");    
+    } while (FDeepen(bd, mvBestAll, mvBest, mpdhd[0].pv, abInit, dLim) &&
              vmv.size() > 1);
 
     /* finish logging */
@@ -278,10 +354,24 @@ MV AI::MvBest(BD& bdGame, const TMAN& tman) noexcept
 
 EV AI::EvSearchPv(BD& bd, AB abInit, int d, int dLim, HD mpdhd[], SO so) noexcept
 {
+    /* don't run off the end of the search stack */
+    if (d >= dMax - 1)
+        return EvLeaf(EvStatic(bd), "max depth");
+
+    /* we're still on the previous iteration's PV if our parent was and the
+       move that got us here was the next one in it */
+    mpdhd[d].pv.clear();
+    mpdhd[d].fFollowPv = mpdhd[d - 1].fFollowPv && 
+        d - 1 < pvBestAll.size() && 
+        pvBestAll[d - 1] == bd.vmvuGame.back();
+    InitContinuation(bd, mpdhd, d);
+
+    /* extend checks, but extensions stop at twice the iteration depth so a 
+       long line of them can't run away */
     mpdhd[d].fInCheck = bd.FInCheck(bd.cpcToMove);
-    dLim += mpdhd[d].fInCheck;
+    dLim += mpdhd[d].fInCheck && FExtend(d);
     if (d >= dLim)
-        return EvQuiescent(bd, abInit, d, mpdhd);
+        return EvQuiescent(bd, abInit, d, mpdhd, set.fQuiescentChecks);
 
     stat.cmvSearch++;
 
@@ -290,7 +380,7 @@ EV AI::EvSearchPv(BD& bd, AB abInit, int d, int dLim, HD mpdhd[], SO so) noexcep
         return evInterrupt;
 
     /* mate distance pruning */
-    abInit.evAlpha = max(abInit.evAlpha, -EvMate(d));
+    abInit.evAlpha = max(abInit.evAlpha, (EV)-EvMate(d));
     abInit.evBeta = min(abInit.evBeta, EvMate(d));
     if (abInit.FEmpty())
         return EvLeaf(abInit.evAlpha, "mate distance");
@@ -299,10 +389,24 @@ EV AI::EvSearchPv(BD& bd, AB abInit, int d, int dLim, HD mpdhd[], SO so) noexcep
     if (bd.FGameDrawn(2))
         return EvLeaf(evDraw, "draw");
 
-    /* check transposition table */
+    /* if we can move back into a position in the search tree, we can force 
+       a draw, so we'll do at least that well */
+    if (abInit.evAlpha < evDraw && bd.FUpcomingRepeat(d)) {
+        abInit.evAlpha = evDraw;
+        if (abInit.FEmpty())
+            return EvLeaf(evDraw, "upcoming repetition");
+    }
+
+    /* check transposition table; the singular extension search excludes a
+       move, so the table doesn't have its result */
+    bool fExclude = !mpdhd[d].mvcExclude.fIsNil();
     MV mvBest(-evInfinity);
-    if (FLookupXt(bd, mvBest, abInit, d, dLim))
-       return mvBest.ev;
+    if (!fExclude && FLookupXt(bd, mvBest, abInit, d, dLim)) {
+        /* at least keep the transposition table move in the PV */
+        if (!mvBest.fIsNil())
+            mpdhd[d].pv.Set(mvBest);
+        return mvBest.ev;
+    }
 
     /* get a static board evaluation which we'll use for various pruning
        heuristics */
@@ -312,7 +416,7 @@ EV AI::EvSearchPv(BD& bd, AB abInit, int d, int dLim, HD mpdhd[], SO so) noexcep
 
     /* try various pruning tricks */
     bool fTryFutility = false;
-    if (!mpdhd[d].fInCheck && abInit.FIsNull() && !(so & soNoPruningHeuristics)) {
+    if (!mpdhd[d].fInCheck && abInit.FIsNull() && !fExclude && !(so & soNoPruningHeuristics)) {
         if (FTryReverseFutility(bd, abInit, d, dLim, mpdhd))
             return mpdhd[d].evStatic;
         if (FTryNullMove(bd, abInit, d, dLim, mpdhd))
@@ -323,18 +427,39 @@ EV AI::EvSearchPv(BD& bd, AB abInit, int d, int dLim, HD mpdhd[], SO so) noexcep
             fTryFutility = true;
     }
 
-    /* generate pseudo-legal moves */
+    /* extend the transposition table move if it's the only good one, and
+       cut if there's more than one move that beats beta */
+    MVC mvcSingular;
+    EV evMultiCut;
+    if (FTrySingularExtension(bd, abInit, d, dLim, mpdhd, so, mvcSingular, evMultiCut))
+        return evMultiCut;
+
+    /* try the moves; the smart iterator generates them in stages as it 
+       goes, so a cut on an early move saves us generating the rest. When 
+       we're in check, there are only a few evasions, so we just generate 
+       them all up front */
     VMV vmv;
-    bd.MoveGenPseudo(vmv);
-    stat.cmvMoveGen += vmv.size();
     AB ab = abInit;
-
-    /* try the moves in the move list */
-    for (VMV::siterator pmv = vmv.InitMv(bd, *this); 
+    mpdhd[d].mvcPv = mpdhd[d].fFollowPv && d < pvBestAll.size() ? pvBestAll[d] : MVC();
+    FTryInternalIterativeReduction(bd, abInit, mpdhd[d].mvcPv, d, dLim);
+    if (mpdhd[d].fInCheck) {
+        bd.MoveGenEvasions(vmv);
+        stat.cmvMoveGen += vmv.size();
+    }
+    const int cmvTriedMax = 64;
+    MVC amvcTried[cmvTriedMax];   // quiet moves that didn't cut, for continuation history
+    int cmvTried = 0;
+    for (VMV::siterator pmv = mpdhd[d].fInCheck ? vmv.InitMv(bd, *this, &mpdhd[d]) : vmv.InitMvStaged(bd, *this, &mpdhd[d]); 
             vmv.FGetMv(pmv, bd); 
             vmv.NextMv(pmv)) {
-        brk.Check(d, *pmv); brk.LogMvStart(*pmv, ab);
+        if (fExclude && MVC(*pmv) == mpdhd[d].mvcExclude) {
+            bd.UndoMv();
+            vmv.cmvLegal--;
+            continue;
+        }
+        brkSearch.Check(d, *pmv); brkSearch.LogMvStart(*pmv, ab);
         pmv->fNoisy = bd.FMvWasNoisy();
+        int dLimMv = dLim + (MVC(*pmv) == mvcSingular && FExtend(d));
         mpdhd[d].cmvQuiet += !pmv->fNoisy;
 
         // REVIEW: some of thse tests test cmvLegal > 1, others if ab.evAlpha 
@@ -342,41 +467,61 @@ EV AI::EvSearchPv(BD& bd, AB abInit, int d, int dLim, HD mpdhd[], SO so) noexcep
         // equivalent? Is raising alpha a better test than cmvLegal > 1 for
         // futility?
 
-        /* late move pruning and reduction */
-        int ddReduction = 0;
-        if ((fTryFutility && vmv.cmvLegal > 1 && FMvWasFutile(bd, *pmv)) ||
-                FMvLateMovePruning(bd, *pmv, d, dLim, mpdhd) ||
-                FMvLateMoveReduction(bd, *pmv, ddReduction)) {
+        /* futility and late move pruning; if everything we've tried so far
+           gets mated, the moves we'd prune are our only hope, so we don't
+           prune until we have a move that doesn't lose */
+        if (mvBest.ev > -evMateMin &&
+                ((fTryFutility && vmv.cmvLegal > 1 && FMvWasFutile(bd, *pmv)) ||
+                 FMvLateMovePruning(bd, *pmv, d, dLim, mpdhd))) {
             bd.UndoMv();
             continue;
         }
-        /* PV search */
-        if (ab.evAlpha == abInit.evAlpha ||
-                !FPvSearch(bd, *pmv, ab, d, dLim, mpdhd, so))
-            pmv->ev = -EvSearchPv(bd, -ab, d + 1, dLim, mpdhd, so);
+        /* late move reduction and PV search, either of which falls back to
+           a full search if the quick search fails high */
+        if (!FMvLateMoveReduction(bd, *pmv, ab, d, dLimMv, mpdhd, vmv.cmvLegal, so) &&
+                (ab.evAlpha == abInit.evAlpha ||
+                 !FPvSearch(bd, *pmv, ab, d, dLimMv, mpdhd, so)))
+            pmv->ev = -EvSearchPv(bd, -ab, d + 1, dLimMv, mpdhd, so);
         bd.UndoMv();
-        if (FPrune(ab, *pmv, mvBest, dLim))
+        EV evAlpha = ab.evAlpha;
+        if (FPrune(ab, *pmv, mvBest, dLim)) {
+            stat.cmvCut++;
+            stat.cmvCutFirst += vmv.cmvLegal == 1;
+            if (fExclude)
+                return pmv->ev;
+            if (!bd.FMvIsNoisy(*pmv))
+                AddContinuation(bd, mpdhd[d], *pmv, amvcTried, cmvTried, dLim - d);
             return SaveCut(bd, *pmv, ab, d, dLim);
-        brk.LogMvEnd(*pmv);
+        }
+        if (!bd.FMvIsNoisy(*pmv) && cmvTried < cmvTriedMax)
+            amvcTried[cmvTried++] = MVC(*pmv);
+        if (ab.evAlpha > evAlpha)
+            mpdhd[d].pv.Set(*pmv, mpdhd[d + 1].pv);
+        brkSearch.LogMvEnd(*pmv);
     }
 
-    if (vmv.cmvLegal == 0) {
+    if (fExclude) {
+        /* the excluded move may have been the only legal one */
+        if (vmv.cmvLegal == 0)
+            return abInit.evAlpha;
+    }
+    else if (vmv.cmvLegal == 0) {
         /* if no legal moves, we have a checkmate or stalemate */
         stat.cmvLeaf++;
         mvBest = MV(mpdhd[d].fInCheck ? -EvMate(d) : evDraw);
         SaveXt(bd, mvBest, AB(-evInfinity, evInfinity), d, dLim);
-        brk.LogEnd(mvBest.ev, mpdhd[d].fInCheck ? "mate" : "stalemate");
+        brkSearch.LogEnd(mvBest.ev, mpdhd[d].fInCheck ? "mate" : "stalemate");
     }
     else {
         SaveXt(bd, mvBest, abInit, d, dLim);
-        brk.LogEnd(mvBest.ev, "best");
+        brkSearch.LogEnd(mvBest.ev, "best");
     }
 
     return mvBest.ev;
 }
 
 /**
- *  @fn         EV AI::EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[])
+ *  @fn         EV AI::EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[], bool fChecks)
  *  @brief      Recursive quiescent search
  * 
  *  @detils     A common problem with chess search is trying to get a static 
@@ -386,10 +531,23 @@ EV AI::EvSearchPv(BD& bd, AB abInit, int d, int dLim, HD mpdhd[], SO so) noexcep
  *              checking all captures, until we reach a quiescent state, and 
  *              then we evaluate the board.Alpha-beta pruning applies to 
  *              quiescent moves, too.
+ *
+ *              When we're in check, the static eval isn't a score we can
+ *              stand on, so we try all the evasions, and if there aren't
+ *              any, it's checkmate.
+ * 
+ *              If fChecks is set, which the main search does on the first
+ *              ply of quiescent search, we also try the quiet moves that
+ *              give check, which finds a lot of mates and forks that the
+ *              captures alone miss. They aren't captures, so they're scored
+ *              and sorted ahead of the losing captures.
  */
 
-EV AI::EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[]) noexcept
+EV AI::EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[], bool fChecks) noexcept
 {
+    if (d >= dMax - 1)
+        return EvLeaf(EvStatic(bd), "max depth");
+
     stat.cmvQuiescent++;
 
     if (FInterrupt())
@@ -400,39 +558,56 @@ EV AI::EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[]) noexcept
     mpdhd[d].evStatic = EvStatic(bd);
     mpdhd[d].fImproving = d >= 2 && mpdhd[d].evStatic > mpdhd[d - 2].evStatic;
     mpdhd[d].cmvQuiet = 0;
-    MV mvBest(mpdhd[d].evStatic);
-    if (FPrune(ab, mvBest)) {
+
+    /* when we're in check, we can't stand pat on the static eval; we have to 
+       get out of check, and if we can't, it's checkmate */
+    MV mvBest(mpdhd[d].fInCheck ? -EvMate(d) : mpdhd[d].evStatic);
+    if (mpdhd[d].fInCheck)
+        brkSearch.LogEnd(mpdhd[d].evStatic, "eval", "check");
+    else if (FPrune(ab, mvBest)) {
         stat.cmvLeaf++;
-        brk.LogEnd(mvBest.ev, "eval", "cut");
+        brkSearch.LogEnd(mvBest.ev, "eval", "cut");
         return mvBest.ev;
     }
-    brk.LogEnd(mvBest.ev, "eval");
+    else
+        brkSearch.LogEnd(mvBest.ev, "eval");
 
     VMV vmv;
     if (mpdhd[d].fInCheck)
-        bd.MoveGenPseudo(vmv);
-    else
+        bd.MoveGenEvasions(vmv);
+    else {
         bd.MoveGenNoisy(vmv);
+        if (fChecks)
+            bd.MoveGenQuietChecks(vmv);
+    }
     stat.cmvMoveGen += vmv.size();
 
     for (VMV::siterator pmv = vmv.InitMv(bd, *this); vmv.FGetMv(pmv, bd); vmv.NextMv(pmv)) {
-        brk.Check(d, *pmv);
-        brk.LogMvStart(*pmv, ab, "q");
-        pmv->ev = -EvQuiescent(bd, -ab, d + 1, mpdhd);
+        /* losing captures are sorted last, and aren't worth looking at unless 
+           we're getting out of check */
+        if (pmv->evenum == EVENUM::BadCapt && !mpdhd[d].fInCheck) {
+            bd.UndoMv();
+            stat.cmvSeePruning += vmv.size() - vmv.cmvLegal + 1;
+            break;
+        }
+        brkSearch.Check(d, *pmv);
+        brkSearch.LogMvStart(*pmv, ab, "q");
+        mpdhd[d + 1].fInCheck = bd.FInCheck(bd.cpcToMove);
+        pmv->ev = -EvQuiescent(bd, -ab, d + 1, mpdhd, false);
         bd.UndoMv();
         if (FPrune(ab, *pmv, mvBest)) {
-            brk.LogMvEnd(*pmv, "cut");
+            brkSearch.LogMvEnd(*pmv, "cut");
             return pmv->ev;
         }
-        brk.LogMvEnd(*pmv);
+        brkSearch.LogMvEnd(*pmv);
     }
 
     if (vmv.cmvLegal == 0) {
         stat.cmvLeaf++;
-        brk.LogEnd(mvBest.ev, "leaf");
+        brkSearch.LogEnd(mvBest.ev, mpdhd[d].fInCheck ? "mate" : "leaf");
     }
     else {
-        brk.LogEnd(mvBest.ev, "best");
+        brkSearch.LogEnd(mvBest.ev, "best");
     }
     return mvBest.ev;
 }
@@ -446,6 +621,12 @@ EV AI::EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[]) noexcept
  *              and sort the moves by that evaluation. If we ever get a beta 
  *              cut, that means we save the evaluation of types that we didn't 
  *              get to.
+ * 
+ *              A staged move list starts out empty, and the iterator 
+ *              generates moves as it reaches the evenum that needs them: the 
+ *              transposition table move first, then the captures, then the 
+ *              killers, and only then the quiet moves. Cut nodes usually never
+ *              get as far as generating the quiet moves.
  */
 
 /**
@@ -464,10 +645,7 @@ EV AI::EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[]) noexcept
 
 VMV::siterator VMV::sbegin(AI& ai, BD& bd) noexcept
 {
-    VMV::siterator sit = siterator(&ai, &bd,
-                                   &reinterpret_cast<MV*>(amv)[0],
-                                   &reinterpret_cast<MV*>(amv)[imvMac]);
-    return sit;
+    return siterator(&ai, &bd, this, 0);
 }
 
 /**
@@ -477,42 +655,57 @@ VMV::siterator VMV::sbegin(AI& ai, BD& bd) noexcept
 
 VMV::siterator VMV::send(void) noexcept
 {
-    return siterator(nullptr, nullptr, &reinterpret_cast<MV*>(amv)[imvMac], nullptr);
+    return siterator(nullptr, nullptr, nullptr, imvMac);
 }
 
 /**
- *  @fn         VMV::siterator VMV::InitMv(BD& bd, AI& ai)
+ *  @fn         VMV::siterator VMV::InitMv(BD& bd, AI& ai, const HD* phd)
  *  @brief      Initializes the smart move iterator
  * 
  *  @details    Resets the legal move count and returns an iterator to the
- *              start of the move list.
+ *              start of the move list. phd is the search stack entry for 
+ *              this node, which has the previous iteration's PV move and
+ *              the history tables that depend on how we got here. It's 
+ *              null in the quiescent search.
  */
 
-VMV::siterator VMV::InitMv(BD& bd, AI& ai) noexcept
+VMV::siterator VMV::InitMv(BD& bd, AI& ai, const HD* phd) noexcept
 {
     cmvLegal = 0;
+    this->phd = phd;
     return sbegin(ai, bd);
 }
 
 /**
- *  @fn         bool VMV::FGetMv(VMV::siterator& pmv, BD& bd)
- *  @brief      Gets the next legal move from the smart iterator
+ *  @fn         VMV::siterator VMV::InitMvStaged(BD& bd, AI& ai, const HD* phd)
+ *  @brief      Initializes the smart move iterator on an empty move list
  * 
- *  @details    Will not return invalid pseudo moves that are invalid.
+ *  @details    The iterator will generate the legal moves in stages as it
+ *              needs them.
+ */
+
+VMV::siterator VMV::InitMvStaged(BD& bd, AI& ai, const HD* phd) noexcept
+{
+    clear();
+    fStaged = true;
+    return InitMv(bd, ai, phd);
+}
+
+/**
+ *  @fn         bool VMV::FGetMv(VMV::siterator& pmv, BD& bd)
+ *  @brief      Gets the next move from the smart iterator and makes it
  * 
- *  TODO: should actually remove moves that aren't legal
+ *  @details    The move lists we search come from the legal move generators,
+ *              so there is no need to test the move after we make it.
  */
 
- bool VMV::FGetMv(VMV::siterator& pmv, BD& bd) noexcept
+bool VMV::FGetMv(VMV::siterator& pmv, BD& bd) noexcept
 {
-    while (pmv != send()) {
-        if (bd.FMakeMvLegal(*pmv)) {
-            cmvLegal++;
-            return true;
-        }
-        ++pmv;
-    }
-    return false;
+    if (pmv.imvCur >= imvMac)
+        return false;
+    bd.MakeMv(*pmv);
+    cmvLegal++;
+    return true;
 }
 
 /**
@@ -526,19 +719,33 @@ void VMV::NextMv(VMV::siterator& sit) noexcept
 }
 
 /**
- *  @fn         VMV::siterator::siterator(AI* pai, BD* pbd, MV* pmv, MV * pmvMac)
+ *  @fn         void VMV::Swap(int imv1, int imv2)
+ *  @brief      Swaps two moves in the move list, along with their scores
+ */
+
+void VMV::Swap(int imv1, int imv2) noexcept
+{
+    swap(amvc[imv1], amvc[imv2]);
+    swap(mpimvev[imv1], mpimvev[imv2]);
+    swap(mpimvevenum[imv1], mpimvevenum[imv2]);
+}
+
+/**
+ *  @fn         VMV::siterator::siterator(AI* pai, BD* pbd, VMV* pvmv, int imv)
  *  @brief      Constructor for the smart move list iterator
  *  
  *  @details    The work to move to the first of the sorted moves is done here, 
  *              and the move list may be scanned and moves scored.
  */
 
-VMV::siterator::siterator(AI* pai, BD* pbd, MV* pmv, MV* pmvMac) noexcept :
-    iterator(pmv),
-    pmvMac(pmvMac),
+VMV::siterator::siterator(AI* pai, BD* pbd, VMV* pvmv, int imv) noexcept :
     pai(pai),
-    pbd(pbd)
+    pbd(pbd),
+    pvmv(pvmv),
+    imvCur(imv)
 {
+    if (pvmv == nullptr)
+        return;
     InitEvEnum();
     NextBestScore();
 }
@@ -550,7 +757,7 @@ VMV::siterator::siterator(AI* pai, BD* pbd, MV* pmv, MV* pmvMac) noexcept :
 
 VMV::siterator& VMV::siterator::operator ++ () noexcept
 {
-    ++pmvCur;
+    ++imvCur;
     NextBestScore();
     return *this;
 }
@@ -567,61 +774,119 @@ VMV::siterator& VMV::siterator::operator ++ () noexcept
 
 void VMV::siterator::InitEvEnum(void) noexcept
 {
+    EV* mpimvev = pvmv->mpimvev;
+    EVENUM* mpimvevenum = pvmv->mpimvevenum;
+    MV mv;
+
     switch (evenum) {
     case EVENUM::None:
-        for (MV* pmv = pmvCur; pmv < pmvMac; pmv++)
-            pmv->evenum = EVENUM::None;
+        for (int imv = imvCur; imv < pvmv->imvMac; imv++)
+            mpimvevenum[imv] = EVENUM::None;
         break;
 
-    case EVENUM::PV:    /* principle variation should be in the transposition table */
+    case EVENUM::PV:    /* the previous iteration's principal variation, or failing
+                           that, the transposition table's best move */
     {
-        XTEV* pxtev = pai->xt.Find(*pbd, 0);
-        if (pxtev != nullptr && ((TEV)pxtev->tev == TEV::Equal || (TEV)pxtev->tev == TEV::Higher)) {
-            for (MV* pmv = pmvCur; pmv < pmvMac; pmv++)
-                if (*pmv == pxtev->Mv()) {
-                    pmv->ev = pxtev->Ev(1);
-                    pmv->evenum = EVENUM::PV;
-                    break;
-                }
+        MVC mvcPv = pvmv->phd != nullptr ? pvmv->phd->mvcPv : MVC();
+        EV evPv = 0;
+        if (mvcPv.fIsNil()) {
+            XTEV* pxtev = pai->xt.Find(*pbd, 0);
+            if (pxtev == nullptr || !((TEV)pxtev->tev == TEV::Equal || (TEV)pxtev->tev == TEV::Higher))
+                break;
+            mvcPv = pxtev->Mvc();
+            evPv = pxtev->Ev(1);
         }
+        if (pvmv->fStaged && pbd->FMvIsLegal(MV(mvcPv)))
+            AddStaged(MV(mvcPv));
+        for (int imv = imvCur; imv < pvmv->imvMac; imv++)
+            if (pvmv->amvc[imv] == mvcPv) {
+                mpimvev[imv] = evPv;
+                mpimvevenum[imv] = EVENUM::PV;
+                break;
+            }
         break;
     }
-    case EVENUM::GoodCapt:  /* good captures based on MVV-LVA heuristifc */
-        for (MV* pmv = pmvCur; pmv < pmvMac; pmv++) {
-            if (pbd->FMvIsCapture(*pmv)) {
-                pai->ScoreCapture(*pbd, *pmv);
-                pmv->evenum = pmv->ev > -200 ? EVENUM::GoodCapt : EVENUM::BadCapt;
+    case EVENUM::GoodCapt:  /* captures that don't lose material, in MVV-LVA order */
+        if (pvmv->fStaged)
+            GenStage(GEN::Noisy);
+        for (int imv = imvCur; imv < pvmv->imvMac; imv++) {
+            mv = (*pvmv)[imv];
+            if (pbd->FMvIsCapture(mv)) {
+                pai->ScoreCapture(*pbd, mv);
+                mpimvev[imv] = mv.ev;
+                mpimvevenum[imv] = pbd->SeeGe(mv, 0) ? EVENUM::GoodCapt : EVENUM::BadCapt;
             }
         }
         break;
 
     case EVENUM::Killer:    /* killer moves */
-        for (MV* pmv = pmvCur; pmv < pmvMac; pmv++)
-            if (pmv->evenum == EVENUM::None && pai->FScoreKiller(*pbd, *pmv))
-                pmv->evenum = EVENUM::Killer;
+        if (pvmv->fStaged) {
+            int imvGame = (int)pbd->vmvuGame.size() + 1;
+            for (int imv = 0; imvGame < AI::cmvKillersGameMax && imv < AI::cmvKillersMoveMax; imv++) {
+                MVC mvcKiller = pai->amvcKillers[imvGame][imv];
+                MV mvKiller(mvcKiller);
+                if (!FStaged(mvcKiller) && pbd->FMvIsLegal(mvKiller) && !pbd->FMvIsCapture(mvKiller))
+                    AddStaged(mvKiller);
+            }
+        }
+        for (int imv = imvCur; imv < pvmv->imvMac; imv++) {
+            if (mpimvevenum[imv] != EVENUM::None)
+                continue;
+            mv = (*pvmv)[imv];
+            if (pai->FScoreKiller(*pbd, mv)) {
+                mpimvev[imv] = mv.ev;
+                mpimvevenum[imv] = EVENUM::Killer;
+            }
+        }
         break;
 
-    case EVENUM::History:   /* move history */
-        for (MV* pmv = pmvCur; pmv < pmvMac; pmv++)
-            if (pmv->evenum == EVENUM::None && pai->FScoreHistory(*pbd, *pmv))
-                pmv->evenum = EVENUM::History;
+    case EVENUM::History:   /* move history, counter moves, and continuation history */
+        if (pvmv->fStaged)
+            GenStage(GEN::Quiet);
+        for (int imv = imvCur; imv < pvmv->imvMac; imv++) {
+            if (mpimvevenum[imv] != EVENUM::None)
+                continue;
+            mv = (*pvmv)[imv];
+            if (pai->FScoreHistory(*pbd, mv, pvmv->phd)) {
+                mpimvev[imv] = mv.ev;
+                mpimvevenum[imv] = EVENUM::History;
+            }
+        }
         break;
 
     case EVENUM::Xt:        /* transposition table */
-        for (MV* pmv = pmvCur; pmv < pmvMac; pmv++)
-            if (pmv->evenum == EVENUM::None && pai->FScoreXt(*pbd, *pmv))
-                pmv->evenum = EVENUM::Xt;
+        for (int imv = imvCur; imv < pvmv->imvMac; imv++) {
+            if (mpimvevenum[imv] != EVENUM::None)
+                continue;
+            mv = (*pvmv)[imv];
+            if (pai->FScoreXt(*pbd, mv)) {
+                mpimvev[imv] = mv.ev;
+                mpimvevenum[imv] = EVENUM::Xt;
+            }
+        }
         break;
 
-    case EVENUM::Other: /* an actual fast board evaluation */
-        for (MV* pmv = pmvCur; pmv < pmvMac; pmv++)
-            if (pmv->evenum == EVENUM::None && pai->FScoreMove(*pbd, *pmv))
-                pmv->evenum = EVENUM::Other;
+    case EVENUM::Other: /* cheap score that doesn't need to make the move */
+    {
+        BB bbThreat = BbPawnAttacks(pbd->BbPieces(~pbd->cpcToMove, cptPawn), ~pbd->cpcToMove);
+        for (int imv = imvCur; imv < pvmv->imvMac; imv++) {
+            if (mpimvevenum[imv] != EVENUM::None)
+                continue;
+            mv = (*pvmv)[imv];
+            if (pai->FScoreMove(*pbd, mv, bbThreat)) {
+                mpimvev[imv] = mv.ev;
+                mpimvevenum[imv] = EVENUM::Other;
+            }
+        }
         break;
+    }
 
-    case EVENUM::BadCapt:   /* bad captures based onh MVV-LVA heuristics */
+    case EVENUM::BadCapt:   /* captures that lose material by static exchange */
         /* these are scored in the GoodCapt */
         break;
+
+    default:
+        break;
     }
 }
 
@@ -638,36 +903,31 @@ void VMV::siterator::InitEvEnum(void) noexcept
  *              This is basically a selection sort, which is O(n^2) but for 
  *              the sizes of the move lists, this is not an issue, and with
  *              a-b pruning, most move lists won't be completely scanned..
+ *              The scan only touches the parallel score and evenum arrays.
  */
 
 void VMV::siterator::NextBestScore(void) noexcept
 {
-    if (pmvCur >= pmvMac)
-        return;
+    const EV* mpimvev = pvmv->mpimvev;
+    const EVENUM* mpimvevenum = pvmv->mpimvevenum;
 
-    MV* pmvBest;
-    while (1) {
-        switch (evenum) {
-        case EVENUM::None:
-            break;  // moves to first type
-        case EVENUM::PV:
-        case EVENUM::GoodCapt:
-        case EVENUM::Killer:
-        case EVENUM::History:
-        case EVENUM::Xt:
-        case EVENUM::Other:
-        case EVENUM::BadCapt:
-            pmvBest = nullptr;
-            for (MV* pmv = pmvCur; pmv < pmvMac; pmv++)
-                if (pmv->evenum == evenum && (!pmvBest || pmv->ev > pmvBest->ev))
-                    pmvBest = pmv;
-            if (pmvBest)
-                goto GotIt;
-            break;
-        case EVENUM::Max:
-            /* should handle through all the moves before we get here */
-            assert(false);
-            break;
+    while (evenum < EVENUM::Max) {
+        /* nothing left to sort and nothing left to generate */
+        if (imvCur >= pvmv->imvMac && !(pvmv->fStaged && evenum < EVENUM::History))
+            return;
+
+        if (evenum != EVENUM::None) {
+            int imvBest = -1;
+            for (int imv = imvCur; imv < pvmv->imvMac; imv++)
+                if (mpimvevenum[imv] == evenum && (imvBest < 0 || mpimvev[imv] > mpimvev[imvBest]))
+                    imvBest = imv;
+            if (imvBest >= 0) {
+                if (imvBest != imvCur)
+                    pvmv->Swap(imvBest, imvCur);
+                mvCur = (*pvmv)[imvCur];
+                mvCur.evenum = evenum;
+                return;
+            }
         }
 
         /* didn't find one - move to next enum type */
@@ -675,9 +935,50 @@ void VMV::siterator::NextBestScore(void) noexcept
         InitEvEnum();
     }
 
-GotIt:
-    if (pmvBest != pmvCur)
-        swap(*pmvBest, *pmvCur);
+    /* should handle all the moves before we get here */
+    assert(imvCur >= pvmv->imvMac);
+}
+
+/**
+ *  @fn         void VMV::siterator::GenStage(GEN gen)
+ *  @brief      Generates the next batch of moves in a staged move list
+ * 
+ *  @details    The new moves are added to the end of the move list, except 
+ *              the ones we already added out of turn from the transposition 
+ *              and killer tables.
+ */
+
+void VMV::siterator::GenStage(GEN gen) noexcept
+{
+    int imvFirst = pvmv->imvMac;
+    pbd->MoveGenLegal(gen, *pvmv);
+    int imvTo = imvFirst;
+    for (int imv = imvFirst; imv < pvmv->imvMac; imv++)
+        if (!FStaged(pvmv->amvc[imv]))
+            pvmv->amvc[imvTo++] = pvmv->amvc[imv];
+    pvmv->resize(imvTo);
+    pai->stat.cmvMoveGen += imvTo - imvFirst;
+}
+
+/**
+ *  @fn         void VMV::siterator::AddStaged(const MV& mv)
+ *  @brief      Adds a move to a staged move list before its stage
+ */
+
+void VMV::siterator::AddStaged(const MV& mv) noexcept
+{
+    assert(cmvStaged < cmvStagedMax);
+    amvcStaged[cmvStaged++] = MVC(mv);
+    pvmv->emplace_back(mv);
+    pai->stat.cmvMoveGen++;
+}
+
+bool VMV::siterator::FStaged(MVC mvc) const noexcept
+{
+    for (int imv = 0; imv < cmvStaged; imv++)
+        if (amvcStaged[imv] == mvc)
+            return true;
+    return false;
 }
 
 /**
@@ -791,23 +1092,26 @@ EV AI::SaveCut(BD& bd, const MV& mv, AB ab, int d, int dLim) noexcept
         AddHistory(bd, mv, d, dLim);
     }
     SaveXt(bd, mv, ab, d, dLim);
-    brk.LogMvEnd(mv, "cut");
+    brkSearch.LogMvEnd(mv, "cut");
     return mv.ev;
 }
 
 EV AI::EvLeaf(EV ev, string_view sLog) noexcept
 {
     stat.cmvLeaf++;
-    brk.LogEnd(ev, sLog);
+    brkSearch.LogEnd(ev, sLog);
     return ev;
 }
 
 /**
- *  @fn         bool AI::FDeepen(BD& bd, MV& mvBestAll, MV mvBest, AB& ab, int& d)
+ *  @fn         bool AI::FDeepen(BD& bd, MV& mvBestAll, MV mvBest, const PV& pv, AB& ab, int& d)
  *  @brief      Iterative deepening and aspiration window adjustment.
+ * 
+ *  @details    When the search at this depth is complete, pv is saved, 
+ *              reported, and followed first by the next iteration.
  */
 
-bool AI::FDeepen(BD& bd, MV& mvBestAll, MV mvBest, AB& ab, int& d) noexcept
+bool AI::FDeepen(BD& bd, MV& mvBestAll, MV mvBest, const PV& pv, AB& ab, int& d) noexcept
 {
     /* If the search failed with a narrow a-b window, widen the window up some
        and try again */
@@ -821,12 +1125,14 @@ bool AI::FDeepen(BD& bd, MV& mvBestAll, MV mvBest, AB& ab, int& d) noexcept
            a-b window (the aspiration window optimization) at first in hopes
            we'll get lots of pruning */
         mvBestAll = mvBest;
+        pvBestAll = pv;
+        ReportDepth(bd, d, mvBest);
         if (FEvIsMate(mvBest.ev) || FEvIsMate(-mvBest.ev))
             return false;
         ab = set.fAspiration ? AbAspiration(mvBest.ev, 40) : AbInfinite();
         d += 1;
     }
-    return d < dSearchMax;
+    return d <= dSearchMax;
 }
 
 /**
@@ -871,7 +1177,7 @@ bool AI::FLookupXt(BD& bd, MV& mvBest, AB ab, int d, int dLim) noexcept
     pxtev->GetMv(mvBest);
 
     stat.cmvXt++;
-    brk.LogEnd(mvBest.ev, "xt");
+    brkSearch.LogEnd(mvBest.ev, "xt");
 
     return true;
 }
@@ -927,18 +1233,16 @@ void XTEV::Save(HA ha, TEV tev, EV ev, const MV& mvBest, int d, int dLim) noexce
     this->tev = static_cast<int8_t>(tev);
     this->evBiased = ev;
     this->dd = dLim - d;
-    this->sqFrom = mvBest.sqFrom;
-    this->sqTo = mvBest.sqTo;
-    this->csMove = mvBest.csMove;
-    this->cptPromote = mvBest.cptPromote;
+    this->mvc = MVC(mvBest);
 }
 
 void XTEV::GetMv(MV& mv) const noexcept
 {
-    mv.sqFrom = (SQ)sqFrom;
-    mv.sqTo = (SQ)sqTo;
-    mv.csMove = (CS)csMove;
-    mv.cptPromote = (CPT)cptPromote;
+    MV mvXt(mvc);
+    mv.sqFrom = mvXt.sqFrom;
+    mv.sqTo = mvXt.sqTo;
+    mv.csMove = mvXt.csMove;
+    mv.cptPromote = mvXt.cptPromote;
 }
 
 /**
@@ -1013,7 +1317,7 @@ bool AI::FTryReverseFutility(BD& bd, AB ab, int d, int dLim, HD mpdhd[]) noexcep
     mpdhd[d].evStatic -= devMargin;
 
     stat.cmvRevFutility++;
-    brk.LogEnd(mpdhd[d].evStatic, "reverse futility");
+    brkSearch.LogEnd(mpdhd[d].evStatic, "reverse futility");
     
     return true;
 }
@@ -1061,7 +1365,7 @@ bool AI::FTryNullMove(BD& bd, AB ab, int d, int dLim, HD mpdhd[]) noexcept
     mpdhd[d].evStatic = evReduced;
 
     stat.cmvNullMove++;
-    brk.LogEnd(mpdhd[d].evStatic, "null");
+    brkSearch.LogEnd(mpdhd[d].evStatic, "null");
     
     return true;
 }
@@ -1108,14 +1412,14 @@ bool AI::FTryRazoring(BD& bd, AB ab, int d, int dLim, HD mpdhd[]) noexcept
     EV dev = 3 * mpdddevFutility[dLim - d];
     if (!ab.FIsBelow(mpdhd[d].evStatic + dev))
         return false;
-    EV evReduced = EvQuiescent(bd, ab, d, mpdhd);
+    EV evReduced = EvQuiescent(bd, ab, d, mpdhd, set.fQuiescentChecks);
     if (!ab.FIsBelow(evReduced))
         return false;
 
     mpdhd[d].evStatic = ab.evAlpha;
 
     stat.cmvRazoring++;
-    brk.LogEnd(mpdhd[d].evStatic, "razoring");
+    brkSearch.LogEnd(mpdhd[d].evStatic, "razoring");
     
     return true;
 }
@@ -1152,12 +1456,12 @@ bool AI::FTryFutility(BD& bd, AB ab, int d, int dLim, HD mpdhd[]) noexcept
 
 bool AI::FMvWasFutile(BD& bd, const MV& mv) noexcept
 {
-    if (bd.FMvWasNoisy() || bd.FInCheck(~bd.cpcToMove))
+    if ((mv.fNoisy && mv.evenum != EVENUM::BadCapt) || bd.FInCheck(~bd.cpcToMove))
         return false;
     stat.cmvFutilityPruning++;
     stat.cmvLeaf++;
     stat.cmvSearch++;
-    brk.LogMvEnd(mv, "futility");
+    brkSearch.LogMvEnd(mv, "futility");
     return true;
 }
 
@@ -1166,32 +1470,189 @@ bool AI::FMvLateMovePruning(BD& bd, const MV& mv, int d, int dLim, HD mpdhd[]) n
     if (!set.fLateMovePruning ||
             mpdhd[d].fInCheck ||
             dLim - d > 3 ||
-            mv.fNoisy ||
+            (mv.fNoisy && mv.evenum != EVENUM::BadCapt) ||
             bd.FInCheck(~bd.cpcToMove) ||
             mpdhd[d].cmvQuiet <= ((3 + mpdhd[d].fImproving) * (dLim - d)) - 1)
         return false;
     stat.cmvLateMovePruning++;
     stat.cmvLeaf++;
     stat.cmvSearch++;
-    brk.LogMvEnd(mv, "lm prune");
+    brkSearch.LogMvEnd(mv, "lm prune");
     return true;
 }
 
 /**
- *  @fn         bool AI::FMvLateMoveReduction(BD& bd, const MV& mv, int& ddReduction)
+ *  @class      LMR
+ *  @brief      Late move reduction table
+ *
+ *  @details    How many plies to reduce a quiet move, indexed by the depth 
+ *              left to search and the number of moves we've tried so far. 
+ *              Reductions grow with log(depth) * log(move number). The log
+ *              isn't constexpr, so this is built at startup.
+ */
+
+class LMR
+{
+public:
+    LMR(void) noexcept
+    {
+        for (int dd = 1; dd < ddMax; dd++)
+            for (int cmv = 1; cmv < cmvMax; cmv++)
+                mpddcmvdd[dd][cmv] = (int8_t)(0.5 + log((double)dd) * log((double)cmv) / 2.25);
+    }
+
+    int DdReduction(int dd, int cmv) const noexcept
+    {
+        return mpddcmvdd[min(dd, ddMax - 1)][min(cmv, cmvMax - 1)];
+    }
+
+private:
+    static const int ddMax = 64;
+    static const int cmvMax = 64;
+    int8_t mpddcmvdd[ddMax][cmvMax] = { {0} };
+};
+
+static const LMR lmr;
+
+/**
+ *  @fn         bool AI::FMvLateMoveReduction(BD& bd, MV& mv, AB ab, int d, int dLim, HD mpdhd[], int cmvLegal, SO so)
  *  @brief      Late move reduction
  *
- *  @details    If we're well into the move list, try a reduced depth search
- *              on the move to see if it's worth searching fully. Returns the
- *              amount to reduce the depth in ddReduction.
+ *  @details    Quiet moves late in the move list rarely turn out to be best,
+ *              so we search them with a null window to a reduced depth. We
+ *              reduce less in PV nodes, when the position is improving, and
+ *              for killers and moves with a good history, and we never
+ *              reduce captures, promotions, checks, or check evasions. The
+ *              move must already be made on the board.
+ * 
+ *  @returns    true if the reduced search failed low, in which case mv.ev is
+ *              its value and we don't need to search the move any deeper.
+ *              false if we need to do a full depth search.
+ */
+
+bool AI::FMvLateMoveReduction(BD& bd, MV& mv, AB ab, int d, int dLim, HD mpdhd[], int cmvLegal, SO so) noexcept
+{
+    int dd = dLim - d;
+    if (!set.fLateMoveReduction ||
+            dd < 3 ||
+            cmvLegal < 2 + !ab.FIsNull() ||
+            mpdhd[d].fInCheck ||
+            mv.fNoisy ||
+            bd.FInCheck(bd.cpcToMove))
+        return false;
+
+    int ddReduction = lmr.DdReduction(dd, cmvLegal);
+    ddReduction += !mpdhd[d].fImproving;
+    ddReduction -= !ab.FIsNull();
+    /* a history count bigger than one cut-off at this depth would add */
+    ddReduction -= mv.evenum == EVENUM::Killer || 
+                   mpcpsqcHistory[bd[mv.sqTo].cp()][mv.sqTo] > dd * dd;
+    ddReduction = min(ddReduction, dd - 2);
+    if (ddReduction <= 0)
+        return false;
+
+    stat.cmvLateMoveReduction++;
+    mv.ev = -EvSearchPv(bd, -ab.AbNull(), d + 1, dLim - ddReduction, mpdhd, so);
+    return ab.FIsBelow(mv.ev);
+}
+
+/**
+ *  @fn         bool AI::FTryInternalIterativeReduction(BD& bd, AB ab, MVC mvcPv, int d, int& dLim)
+ *  @brief      Internal iterative reduction
+ *
+ *  @details    If a PV node doesn't have a best move from the previous 
+ *              iteration's PV or the transposition table, our move ordering
+ *              is weak and a full depth search here is going to be 
+ *              expensive. Rather than search a shallow level first to find a
+ *              move to try first (internal iterative deepening), we just 
+ *              search this node one ply shallower; the search saves a best 
+ *              move in the transposition table that the next iteration will
+ *              use.
+ * 
+ *              This is off by default. It's a good deal faster on the STS
+ *              positional suites, but misses tactics on WAC.
+ * 
+ *  @returns    true if we reduced dLim.
  */
 
-bool AI::FMvLateMoveReduction(BD& bd, const MV& mv, int& ddReduction) noexcept
+const int ddInternalIterativeReduction = 4;
+
+bool AI::FTryInternalIterativeReduction(BD& bd, AB ab, MVC mvcPv, int d, int& dLim) noexcept
 {
-    if (!set.fLateMoveReduction)
+    if (!set.fInternalIterativeReduction ||
+            ab.FIsNull() ||
+            dLim - d < ddInternalIterativeReduction ||
+            !mvcPv.fIsNil())
+        return false;
+    XTEV* pxtev = xt.Find(bd, 0);
+    if (pxtev != nullptr && !pxtev->Mvc().fIsNil() &&
+            ((TEV)pxtev->tev == TEV::Equal || (TEV)pxtev->tev == TEV::Higher))
         return false;
-;
-    /* Should we gather stats for this? not sure how we'd do it */
+    stat.cmvInternalIterativeReduction++;
+    dLim--;
+    return true;
+}
+
+/**
+ *  @fn         bool AI::FTrySingularExtension(BD& bd, AB ab, int d, int dLim, HD mpdhd[], SO so, MVC& mvcSingular, EV& ev)
+ *  @brief      Singular extension and multi-cut
+ *
+ *  @details    If the transposition table says its move beat beta at nearly
+ *              this depth, we search every other move at reduced depth with
+ *              a window a little below the table's value. If they all fail 
+ *              low, the table move is singular, the only move that holds, 
+ *              and we return it in mvcSingular to be searched a ply deeper.
+ *              If one of the other moves also beats beta, there are at least
+ *              two moves that cut, and we take the cut without searching
+ *              any further.
+ * 
+ *              The reduced search is of this same node with the table move
+ *              excluded. It skips the transposition table, since its result 
+ *              isn't the value of the position, and it leaves this node's 
+ *              search stack entry as it found it.
+ * 
+ *  @returns    true on a multi-cut, with the value to return in ev.
+ */
+
+const int ddSingular = 6;
+
+bool AI::FTrySingularExtension(BD& bd, AB ab, int d, int dLim, HD mpdhd[], SO so, MVC& mvcSingular, EV& ev) noexcept
+{
+    int dd = dLim - d;
+    if (!set.fSingularExtension ||
+            dd < ddSingular ||
+            !mpdhd[d].mvcExclude.fIsNil())
+        return false;
+    XTEV* pxtev = xt.Find(bd, dd - 3);
+    if (pxtev == nullptr || 
+            !((TEV)pxtev->tev == TEV::Equal || (TEV)pxtev->tev == TEV::Higher) ||
+            pxtev->Mvc().fIsNil() ||
+            FEvIsMate(abs(pxtev->Ev(d))) ||
+            !bd.FMvIsLegal(pxtev->Mv()))
+        return false;
+
+    /* the excluded search reuses this node's search stack entry and adds
+       the check extension again, so save the entry and take the extension 
+       back out of the depth we ask for */
+    MVC mvcXt = pxtev->Mvc();
+    EV evSingular = pxtev->Ev(d) - 2 * dd;
+    HD hdSave = mpdhd[d];
+    mpdhd[d].mvcExclude = mvcXt;
+    EV evExclude = EvSearchPv(bd, AB(evSingular - 1, evSingular), d, d + dd / 2 - (hdSave.fInCheck && FExtend(d)), mpdhd, so);
+    mpdhd[d] = hdSave;
+    if (FEvIsInterrupt(evExclude))
+        return false;
+
+    if (evExclude < evSingular) {
+        stat.cmvSingularExtension++;
+        mvcSingular = mvcXt;
+        return false;
+    }
+    if (evSingular >= ab.evBeta) {
+        stat.cmvMultiCut++;
+        ev = evSingular;
+        return true;
+    }
     return false;
 }
 
@@ -1213,7 +1674,7 @@ bool AI::FPvSearch(BD& bd, MV& mv, AB ab, int d, int dLim, HD mpdhd[], SO so) no
 {
     if (!set.fPV)
         return false;
-    mv.ev = -EvSearchPv(bd, -ab.AbNull(), d, dLim, mpdhd, so);
+    mv.ev = -EvSearchPv(bd, -ab.AbNull(), d + 1, dLim, mpdhd, so);
     return ab.FIsBelow(mv.ev);
 }
 
@@ -1228,17 +1689,21 @@ bool AI::FPvSearch(BD& bd, MV& mv, AB ab, int d, int dLim, HD mpdhd[], SO so) no
 
 EV AI::EvStatic(BD& bd) noexcept
 {
-    EV ev = 0;
+    /* the tapered terms are summed as packed middle/end game pairs, and 
+       only split and blended once at the end */
+    EVP evp;
     if (set.fPSQT)
-        ev += EvFromPsqt(bd);
+        evp += EvpFromPsqt(bd);
+    if (set.fKingSafety)
+        evp += EvpKingSafety(bd);
+    if (set.fPawnStructure)
+        evp += EvpPawnStructure(bd);
+    EV ev = EvTaper(bd, evp);
+
     if (set.fMobility)
         ev += EvMobility(bd);
     if (set.fMaterial)
         ev += EvMaterial(bd);
-    if (set.fKingSafety)
-        ev += EvKingSafety(bd);
-    if (set.fPawnStructure)
-        ev += EvPawnStructure(bd);
     if (set.fTempo)
         ev += evTempo;  
     return ev;
@@ -1263,129 +1728,109 @@ EV AI::EvMobility(BD& bd) const noexcept
 }
 
 /**
- *  @fn         void AI::InitPsts(void)
- *  @brief      Initializes the piece square tables
- *
- *  @details    Initializes the piece value weight tables for the different
- *              phases of the game. We may build these tables on the fly in
- *              the future, but for now we waste a little time at beginning
- *              of search, but it's not a big deal.
+ *  @fn         EV AI::EvTaper(const BD& bd, EVP evp) const
+ *  @brief      Blends a middle/end game evaluation pair by the game phase
  */
 
-void AI::InitPsts(void) noexcept
+EV AI::EvTaper(const BD& bd, EVP evp) const noexcept
 {
-    InitPsqt(mpcptevMid, mpcptsqdevMid, mpcpsqevMid);
-    InitPsqt(mpcptevEnd, mpcptsqdevEnd, mpcpsqevEnd);
+    return EvInterpolate(clamp(bd.phase, phaseMidFirst, phaseEndFirst),
+                         evp.evMid(), phaseMidFirst,
+                         evp.evEnd(), phaseEndFirst);
 }
 
 /**
- *  @fn         EV PLAI::EvFromPsqt(const BD& bd)
+ *  @fn         EVP AI::EvpFromPsqt(const BD& bd)
  *  @brief      Piece square table evaluation of the board
  * 
- *  @details    Returns the evaluation of the board as taken from the piece
- *              square tables, interpolating between mid- and end-game 
- *              tables. Also includes simple piece combination evaluations
- *              for things like bishop pairs. 
+ *  @details    Returns the middle and end game evaluation of the board as 
+ *              taken from the piece square tables. Also includes simple 
+ *              piece combination evaluations for things like bishop pairs. 
+ * 
+ *              The board keeps the table totals and piece counts up to date 
+ *              as moves are made, so this is just a couple of adds.
  */
 
-EV AI::EvFromPsqt(const BD& bd) const noexcept
+EVP AI::EvpFromPsqt(const BD& bd) const noexcept
 {
-    EV mpcpcevMid[2] = { 0, 0 };
-    EV mpcpcevEnd[2] = { 0, 0 };
-    int accp[cpMax] = { 0 }; // count each piece type
-    int phase = phaseMax;
-
-    for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc) {
-        for (int icp = 0; icp < 16; ++icp) {
-            int icpbd = bd.aicpbd[cpc][icp];
-            if (icpbd == -1)
-                continue;
-            SQ sq = SqFromIcpbd(icpbd);
-            CP cp = bd.acpbd[icpbd].cp();
-            accp[cp]++;
-            mpcpcevMid[cpc] += mpcpsqevMid[cp][sq];
-            mpcpcevEnd[cpc] += mpcpsqevEnd[cp][sq];
-            phase -= mpcptphase[bd.acpbd[icpbd].cpt];
-        }
-    }
-
-    EV ev = EvInterpolate(clamp(phase, phaseMidFirst, phaseEndFirst),
-                          mpcpcevMid[bd.cpcToMove] - mpcpcevMid[~bd.cpcToMove], phaseMidFirst,
-                          mpcpcevEnd[bd.cpcToMove] - mpcpcevEnd[~bd.cpcToMove], phaseEndFirst);
-    ev += EvPieceCombos(accp, bd.cpcToMove);
-    return ev;
+    EVP evp = bd.mpcpcevp[bd.cpcToMove] - bd.mpcpcevp[~bd.cpcToMove];
+    evp += EvpPieceCombos(bd.mk, bd.cpcToMove);
+    return evp;
 }
 
 /**
- *  @fn         EV AI::EvPieceCombos(int accp[], CPC cpc) const
+ *  @fn         EVP AI::EvpPieceCombos(MK mk, CPC cpc) const
  *  @brief      Computes material advnatge for certain piece combinations
  *
  *  @details    Adjustment for the static board evaluation for various
  *              piece combinations, in particular, provides advantages for
  *              having duplicates, which is primarily bishop pairs.
- *              Send the piece counts in accp, and the color to eval for
+ *              Send the piece counts in the material key mk, and the color to eval for
  *              in cpc.
  */
 
-EV AI::EvPieceCombos(int accp[], CPC cpc) const noexcept
+EVP AI::EvpPieceCombos(MK mk, CPC cpc) const noexcept
 {
-    constexpr EV evBishopPair = 30;
-    constexpr EV evKnightPair = 8;
-    constexpr EV evRookPair = 16;
+    constexpr EVP evpBishopPair(30, 30);
+    constexpr EVP evpKnightPair(8, 8);
+    constexpr EVP evpRookPair(16, 16);
 
-    EV ev = 0;
-    ev += EvPair(accp, cpc, cptBishop, evBishopPair);
-    ev += EvPair(accp, cpc, cptKnight, evKnightPair);
-    ev += EvPair(accp, cpc, cptRook, evRookPair);
-    return ev;
+    EVP evp;
+    evp += EvpPair(mk, cpc, cptBishop, evpBishopPair);
+    evp += EvpPair(mk, cpc, cptKnight, evpKnightPair);
+    evp += EvpPair(mk, cpc, cptRook, evpRookPair);
+    return evp;
 }
 
 /**
- *  @fn         EV AI::EvPair(int accp[], CPC cpc, CPT cpt, EV evPair) const
+ *  @fn         EVP AI::EvpPair(MK mk, CPC cpc, CPT cpt, EVP evpPair) const
  *  @brief      Computes material advantage for having a pair of a piece type
  * 
  *  @details    If the player has more than one of the given piece type, wek
  *              give an evaluation bonus. This checks both sides, positive for
  *              the side to move, negative for the opponent. 
  * 
- *  @param      accp    array of piece counts by type
+ *  @param      mk      material key with the piece counts
  *  @param      cpc     color to evaluate for
  *  @param      cpt     piece type to check for pairs
- *  @param      evPair  evaluation bonus for having the pair
+ *  @param      evpPair evaluation bonus for having the pair
  */
 
-EV AI::EvPair(int accp[], CPC cpc, CPT cpt, EV evPair) const noexcept
+EVP AI::EvpPair(MK mk, CPC cpc, CPT cpt, EVP evpPair) const noexcept
 {
-    EV ev = 0;
-    if (accp[Cp(cpc, cpt)] > 1)
-        ev += evPair;
-    if (accp[Cp(~cpc, cpt)] > 1)
-        ev -= evPair;
-    return ev;
+    EVP evp;
+    if (CcpFromMk(mk, Cp(cpc, cpt)) > 1)
+        evp += evpPair;
+    if (CcpFromMk(mk, Cp(~cpc, cpt)) > 1)
+        evp -= evpPair;
+    return evp;
 }
 
 /**
- *  @fn         EV AI::KingSafety(BD& bd) const
+ *  @fn         EVP AI::EvpKingSafety(BD& bd) const
  *  @brief      Evaluates the safety of the kings
  */
 
-EV AI::EvKingSafety(BD& bd) const noexcept
+EVP AI::EvpKingSafety(BD& bd) const noexcept
 {
-    return EvKingSafety(bd, bd.cpcToMove) - EvKingSafety(bd, ~bd.cpcToMove);
+    return EvpKingSafety(bd, bd.cpcToMove) - EvpKingSafety(bd, ~bd.cpcToMove);
 }
 
-EV AI::EvKingSafety(BD& bd, CPC cpc) const noexcept
+EVP AI::EvpKingSafety(BD& bd, CPC cpc) const noexcept
 {
+    constexpr EVP evpInner(4, 4);
+    constexpr EVP evpOuter(1, 1);
+
     SQ sqKing = bd.SqKing(cpc);
     BB bbInner = mpbb.BbKingInner(sqKing);
     BB bbOuter = mpbb.BbKingOuter(sqKing);
     BB bbAttacked = bd.BbAttacked(~cpc);
 
-    return 4*(bbInner & bbAttacked).csq() + 1*(bbOuter & bbAttacked).csq();
+    return evpInner * (bbInner & bbAttacked).csq() + evpOuter * (bbOuter & bbAttacked).csq();
 }
 
 /**
- *  @#fn        EV AI::EvPawnStructure(BD& bd) const
+ *  @fn         EVP AI::EvpPawnStructure(BD& bd) const
  *  @brief      Pawn structure evaluation
  * 
  *  @details    Evaluates the pawn structure for both sides, returning a
@@ -1393,19 +1838,19 @@ EV AI::EvKingSafety(BD& bd, CPC cpc) const noexcept
  *              into account doubled pawns, isolated pawns, and passed pawns.
  */
 
-EV AI::EvPawnStructure(BD& bd) const noexcept
+EVP AI::EvpPawnStructure(BD& bd) const noexcept
 {
     BB bb = bd.BbPawns(bd.cpcToMove);
     BB bbDefense = bd.BbPawns(~bd.cpcToMove);
 
-    EV ev = EvPawnStructure(bb, bbDefense, bd.cpcToMove);
-    ev -= EvPawnStructure(bbDefense, bb, ~bd.cpcToMove);
+    EVP evp = EvpPawnStructure(bb, bbDefense, bd.cpcToMove);
+    evp -= EvpPawnStructure(bbDefense, bb, ~bd.cpcToMove);
 
-    return ev;
+    return evp;
 }
 
 /**
- *  @fn         EV AI::EvPawnStructure(BB bbPawns, BB bbDefense, CPC cpc) const
+ *  @fn         EVP AI::EvpPawnStructure(BB bbPawns, BB bbDefense, CPC cpc) const
  *  @brief      Pawn structure strudcture, one color
  * 
  *  @details    Evaluates the pawn structure for one side, returning an
@@ -1413,13 +1858,17 @@ EV AI::EvPawnStructure(BD& bd) const noexcept
  *              pawns.
  */
 
-EV AI::EvPawnStructure(BB bbPawns, BB bbDefense, CPC cpc) const noexcept
+EVP AI::EvpPawnStructure(BB bbPawns, BB bbDefense, CPC cpc) const noexcept
 {
-    EV ev = 0;
-    ev -= 10 * CfiDoubledPawns(bbPawns, cpc);
-    ev -= 10 * CfiIsoPawns(bbPawns, cpc);
-    ev += 50 * CfiPassedPawns(bbPawns, bbDefense, cpc);
-    return ev;
+    constexpr EVP evpDoubled(-10, -10);
+    constexpr EVP evpIsolated(-10, -10);
+    constexpr EVP evpPassed(50, 50);
+
+    EVP evp;
+    evp += evpDoubled * CfiDoubledPawns(bbPawns, cpc);
+    evp += evpIsolated * CfiIsoPawns(bbPawns, cpc);
+    evp += evpPassed * CfiPassedPawns(bbPawns, bbDefense, cpc);
+    return evp;
 }
 
 /**
@@ -1487,21 +1936,34 @@ void AI::ScoreCapture(BD& bd, MV& mv) noexcept
         return;
     }
 
+    /* MVV-LVA ordering; whether the capture actually wins material is
+       decided by static exchange evaluation when we classify it */
     CP cpFrom = bd[mv.sqFrom].cp();
     CP cpTo = bd[mv.sqTo].cp();
-    mv.ev = mpcpsqevMid[cpTo][mv.sqTo]; 
-    CPT cptDefender = bd.CptSqAttackedBy(mv.sqTo, ~bd.cpcToMove);
-    if (cptDefender)
-        mv.ev -= mpcpsqevMid[cpFrom][mv.sqFrom];
-    else
-        mv.ev -= mpcpsqevMid[cpFrom][mv.sqFrom] / 8;   // MMV-LVA style move ordering heuristic
+    if (cpTo == cpEmpty)    // en passant
+        cpTo = Cp(~bd.cpcToMove, cptPawn);
+    mv.ev = mpcpsqevp[cpTo][mv.sqTo].evMid() - mpcpsqevp[cpFrom][mv.sqFrom].evMid() / 8;
 }
 
-bool AI::FScoreMove(BD& bd, MV& mv) noexcept
+/**
+ *  @fn         bool AI::FScoreMove(const BD& bd, MV& mv, BB bbThreat)
+ *  @brief      Scores a quiet move without making it
+ * 
+ *  @details    Uses the piece square table change for the moving piece,
+ *              less the value of the piece if it moves onto a square an 
+ *              enemy pawn attacks. The caller computes the enemy pawn
+ *              attacks in bbThreat once for the whole move list. Quiet
+ *              promotions land here too, so they're scored with the 
+ *              promoted piece on the destination square.
+ */
+
+bool AI::FScoreMove(const BD& bd, MV& mv, BB bbThreat) noexcept
 {
-    bd.MakeMv(mv);
-    mv.ev = -(EvFromPsqt(bd) + EvAttackDefend(bd, mv));
-    bd.UndoMv();
+    CP cp = bd[mv.sqFrom].cp();
+    CP cpTo = mv.cptPromote != cptNone ? Cp(bd.cpcToMove, mv.cptPromote) : cp;
+    mv.ev = EvTaper(bd, mpcpsqevp[cpTo][mv.sqTo] - mpcpsqevp[cp][mv.sqFrom]);
+    if (cpt(cp) != cptPawn && (bbThreat & mv.sqTo))
+        mv.ev -= mpcptev[cpt(cp)];
     return true;
 }
 
@@ -1527,7 +1989,7 @@ void AI::InitKillers(void) noexcept
 {
     for (int imvGame = 0; imvGame < cmvKillersGameMax; imvGame++)
         for (int imv = 0; imv < cmvKillersMoveMax; imv++)
-            amvKillers[imvGame][imv] = mvNil;
+            amvcKillers[imvGame][imv] = MVC();
 }
 
 void AI::SaveKiller(BD& bd, const MV& mv) noexcept
@@ -1542,11 +2004,12 @@ void AI::SaveKiller(BD& bd, const MV& mv) noexcept
         return;
 
     /* shift this killer into the first position */
-    if (mv == amvKillers[imvLim][0])
+    MVC mvc(mv);
+    if (mvc == amvcKillers[imvLim][0])
         return;
     for (int imv = cmvKillersMoveMax - 1; imv >= 1; imv--)
-        amvKillers[imvLim][imv] = amvKillers[imvLim][imv - 1];
-    amvKillers[imvLim][0] = mv;
+        amvcKillers[imvLim][imv] = amvcKillers[imvLim][imv - 1];
+    amvcKillers[imvLim][0] = mvc;
 }
 
 bool AI::FScoreKiller(BD& bd, MV& mv) noexcept
@@ -1554,8 +2017,9 @@ bool AI::FScoreKiller(BD& bd, MV& mv) noexcept
     int imvGame = (int)bd.vmvuGame.size() + 1;
     if (imvGame >= cmvKillersGameMax)
         return false;
+    MVC mvc(mv);
     for (int imv = 0; imv < cmvKillersMoveMax; imv++) {
-        if (mv == amvKillers[imvGame][imv]) {
+        if (mvc == amvcKillers[imvGame][imv]) {
             mv.ev = evPawn - 10 * imv;
             return true;
         }
@@ -1571,8 +2035,12 @@ bool AI::FScoreKiller(BD& bd, MV& mv) noexcept
 void AI::InitHistory(void) noexcept
 {
     for (CP cp = 0; cp < cpMax; ++cp)
-        for (SQ sqTo = 0; sqTo < sqMax; sqTo++)
+        for (SQ sqTo = 0; sqTo < sqMax; sqTo++) {
             mpcpsqcHistory[cp][sqTo] = 0;
+            mpcpsqmvcCounter[cp][sqTo] = MVC();
+        }
+    memset(pmpcpsqhtCont1->data(), 0, sizeof(MPCPSQHT));
+    memset(pmpcpsqhtCont2->data(), 0, sizeof(MPCPSQHT));
 }
 
 /**
@@ -1636,46 +2104,95 @@ void AI::AgeHistory(void) noexcept
 }
 
 /**
- *  @fn         bool AI::FScoreHistory(BD& bd, MV& mv)
- *  @brief      Scores a move using the history table
+ *  @fn         bool AI::FScoreHistory(BD& bd, MV& mv, const HD* phd)
+ *  @brief      Scores a move using the history tables
  * 
- *  @details    Looks up the move in the history table and returns true if
- *              it was found. The score is returned in mv.ev.
+ *  @details    Adds up the history table, the continuation history after 
+ *              the last two moves, and a bonus if this is the counter move
+ *              to the move that got us here, and returns true if the total
+ *              is positive. The score is returned in mv.ev.
  */
 
-bool AI::FScoreHistory(BD& bd, MV& mv) noexcept
+const int cCounterBonus = 4096;
+
+bool AI::FScoreHistory(BD& bd, MV& mv, const HD* phd) noexcept
 {
-    if (mpcpsqcHistory[bd[mv.sqFrom].cp()][mv.sqTo] == 0)
+    CP cp = bd[mv.sqFrom].cp();
+    int cHistory = mpcpsqcHistory[cp][mv.sqTo];
+    if (phd != nullptr) {
+        if (phd->phtCont1 != nullptr)
+            cHistory += (*phd->phtCont1)[cp][mv.sqTo];
+        if (phd->phtCont2 != nullptr)
+            cHistory += (*phd->phtCont2)[cp][mv.sqTo];
+        if (phd->sqPrev != sqNil && mpcpsqmvcCounter[phd->cpPrev][phd->sqPrev] == MVC(mv))
+            cHistory += cCounterBonus;
+    }
+    if (cHistory <= 0)
         return false;
-    mv.ev = mpcpsqcHistory[bd[mv.sqFrom].cp()][mv.sqTo];
+    mv.ev = (EV)min(cHistory, (int)evMateMin);
     return true;
 }
 
 /**
- *  @fn         EV AI::EvAttackDefend(BD& bd, const MV& mv) const
- *  @brief      Extreme simplistic move eval
+ *  @fn         void AI::InitContinuation(BD& bd, HD mpdhd[], int d)
+ *  @brief      Sets up the search stack's continuation history for a node
  * 
- *  @brief      This heuristic for board evaluation tries to detect bad moves,
- *              which arhappen if we have moved to an attacked square that is
- *              not defended. This should only be used for pre-sorting the move
- *              list, where we perfect accuracy isn't necessary and speed is of
- *              the4 essence.
- *              The move should already have been made on the board.
- *  @returns    The amount to adjust the score by.
- */
-
-EV AI::EvAttackDefend(BD& bd, const MV& mvPrev) const noexcept
-{
-    CPT cptMove = (CPT)bd[mvPrev.sqTo].cpt;
-    CPT cptAttacker = bd.CptSqAttackedBy(mvPrev.sqTo, bd.cpcToMove);
-    if (cptAttacker != cptNone) {
-        if (cptAttacker < cptMove)
-            return mpcptev[cptMove];
-        CPT cptDefended = bd.CptSqAttackedBy(mvPrev.sqTo, ~bd.cpcToMove);
-        if (cptDefended == cptNone)
-            return mpcptev[cptMove];
+ *  @details    Remembers the piece and square of the move that got us to 
+ *              this node, and points the node at the continuation history
+ *              tables for that move and for our own move before it. Null 
+ *              moves have no continuation.
+ */
+
+void AI::InitContinuation(BD& bd, HD mpdhd[], int d) noexcept
+{
+    HD& hd = mpdhd[d];
+    hd.sqPrev = sqNil;
+    hd.phtCont1 = hd.phtCont2 = nullptr;
+    if (bd.vmvuGame.empty() || bd.vmvuGame.back().fIsNil())
+        return;
+    hd.sqPrev = bd.vmvuGame.back().sqTo();
+    hd.cpPrev = bd[hd.sqPrev].cp();
+    hd.phtCont1 = &(*pmpcpsqhtCont1)[hd.cpPrev][hd.sqPrev];
+    if (d > 0 && mpdhd[d - 1].sqPrev != sqNil)
+        hd.phtCont2 = &(*pmpcpsqhtCont2)[mpdhd[d - 1].cpPrev][mpdhd[d - 1].sqPrev];
+}
+
+/**
+ *  @fn         void AI::AddContinuation(BD& bd, const HD& hd, const MV& mv, const MVC amvcTried[], int cmvTried, int dd)
+ *  @brief      Updates the counter move and continuation history on a cut
+ * 
+ *  @details    The quiet move mv caused a beta cut-off, so it becomes the 
+ *              counter move to the move that got us here. Its continuation
+ *              history goes up, and the quiet moves we tried before it that
+ *              didn't cut go down. Entries move towards the bonus in 
+ *              proportion to how far they are from it, so they stay in 
+ *              range without aging.
+ */
+
+static void AddHt(int16_t& cHistory, int dc) noexcept
+{
+    cHistory += (int16_t)(dc - cHistory * abs(dc) / 16384);
+}
+
+void AI::AddContinuation(BD& bd, const HD& hd, const MV& mv, const MVC amvcTried[], int cmvTried, int dd) noexcept
+{
+    /* captures and promotions that cut are ordered by SEE, and must never
+       become counter moves or get continuation history */
+    assert(!bd.FMvIsNoisy(mv));
+    if (!set.fHistory || hd.sqPrev == sqNil || FEvIsInterrupt(mv.ev))
+        return;
+    mpcpsqmvcCounter[hd.cpPrev][hd.sqPrev] = MVC(mv);
+
+    int dc = min(32 * dd * dd, 4096);
+    for (HT* pht : { hd.phtCont1, hd.phtCont2 }) {
+        if (pht == nullptr)
+            continue;
+        AddHt((*pht)[bd[mv.sqFrom].cp()][mv.sqTo], dc);
+        for (int imv = 0; imv < cmvTried; imv++) {
+            MV mvTried(amvcTried[imv]);
+            AddHt((*pht)[bd[mvTried.sqFrom].cp()][mvTried.sqTo], -dc);
+        }
     }
-    return 0;
 }
 
 /**
@@ -1691,13 +2208,14 @@ EV AI::EvAttackDefend(BD& bd, const MV& mvPrev) const noexcept
 void AI::InitTimeMan(const BD& bdGame, const TMAN& tman) noexcept
 {
     tpSearchStart = TpNow();
+    tpSearchEnd = (TP::max)();
     if (tman.odtpTotal.has_value()) {
         /* hard time limit */
         tpSearchEnd = tpSearchStart + tman.odtpTotal.value();
     }
     else if (tman.mpcpcodtp[bdGame.cpcToMove].has_value()) {
         milliseconds dtpFlag = tman.mpcpcodtp[bdGame.cpcToMove].value();
-        milliseconds dtpInc = tman.mpcpcodtpInc[bdGame.cpcToMove].value();
+        milliseconds dtpInc = tman.mpcpcodtpInc[bdGame.cpcToMove].value_or(0ms);
         /* estimate number of moves left in the game */
         EV evMaterial = bdGame.EvMaterial(cpcWhite) + bdGame.EvMaterial(cpcBlack) - 2 * 100;
         int dnmv = (int)((float)evMaterial / (7800 - 200) * (60 - 10) + 10);
@@ -1709,9 +2227,15 @@ void AI::InitTimeMan(const BD& bdGame, const TMAN& tman) noexcept
                 << duration_cast<milliseconds>(tpSearchEnd - tpSearchStart).count() << "ms"
                 << endl;
     }
-    tpSearchEnd -= 50ms;    // give us a little time to unwind
+    if (tpSearchEnd != (TP::max)())
+        tpSearchEnd -= 50ms;    // give us a little time to unwind
 
-    dSearchMax = tman.odMax.has_value() ? tman.odMax.value() : 100;
+    /* UCI depth takes precedence over engine settings, and looking for a 
+       mate in n moves doesn't need to search deeper than 2n plies */
+    dSearchMax = tman.odMax.has_value() ? tman.odMax.value() : set.dMax;
+    if (tman.odMate.has_value())
+        dSearchMax = min(dSearchMax, 2 * tman.odMate.value());
+    cmvSearchMax = tman.ocmvSearch.value_or(UINT64_MAX);
 
     tint = TINT::Thinking;
 }
@@ -1724,7 +2248,7 @@ bool AI::FInterrupt(void) noexcept
         return false;
 
     stat.cmvLeaf++;
-    brk.LogEnd(evInterrupt, "interrupt");
+    brkSearch.LogEnd(evInterrupt, "interrupt");
 
     return true;
 }
@@ -1734,9 +2258,13 @@ bool AI::FInterrupt(void) noexcept
  *  @brief      Lets the system work for a bit
  *
  *  @details    Will return true if the search should terminate. The triggers
- *              for termination can be things like time limit reached, or the
- *              user hitting the ESC key, the application shutting down, or
- *              some other external trigger that called Interrupt().
+ *              for termination can be things like time limit reached, the
+ *              node count limit reached, or the user hitting the ESC key, 
+ *              the application shutting down, or some other external trigger 
+ *              that called Interrupt() or set fStopSearch.
+ * 
+ *              The headless console build has no message pump, so it only
+ *              terminates on the time, node, and external triggers.
  * 
  *              TODO: This is nowhere near sophisticated enough, and we'll 
  *              almost certainly crash due to UI re-entrancy during AI search.
@@ -1750,11 +2278,14 @@ bool AI::FDoYield(void) noexcept
     }
 
     TP tp = TpNow();
-    if (tp > tpSearchEnd) {
+    if (tp > tpSearchEnd || 
+            fStopSearch || 
+            (uint64_t)(stat.cmvSearch + stat.cmvQuiescent) >= cmvSearchMax) {
         tint = TINT::MoveAndContinue;
         return true;
     }
 
+#ifndef CONSOLE
     MSG msg;
     while (::PeekMessageW(&msg, nullptr, 0, 0, PM_NOREMOVE | PM_NOYIELD)) {
         if (msg.message == WM_QUIT) {
@@ -1774,6 +2305,8 @@ bool AI::FDoYield(void) noexcept
             ::DispatchMessageW(&msg);
         }
     }
+#endif // CONSOLE
+
     return false;
 }
 
@@ -1797,7 +2330,7 @@ void STATAI::Log(ostream& os, milliseconds ms) noexcept
     this->ms = ms;
     int64_t cmvTotal = cmvSearch + cmvQuiescent;
     os << "Total nodes: " << cmvTotal << " | "
-            << (int)(cmvTotal / ms.count()) << " nodes/ms"  
+            << (int)(cmvTotal / max((int64_t)ms.count(), (int64_t)1)) << " nodes/ms"  
             << endl;
     LogCmv(os, "Quiescent nodes", cmvQuiescent, cmvTotal);
     LogCmv(os, "Leaf nodes", cmvLeaf, cmvTotal);
@@ -1808,6 +2341,12 @@ void STATAI::Log(ostream& os, milliseconds ms) noexcept
     LogCmv(os, "Null move", cmvNullMove, cmvTotal);
     LogCmv(os, "Futility Pruning", cmvFutilityPruning, cmvTotal);
     LogCmv(os, "Late Move Pruning", cmvLateMovePruning, cmvTotal);
+    LogCmv(os, "Late Move Reduction", cmvLateMoveReduction, cmvTotal);
+    LogCmv(os, "Internal Iterative Reduction", cmvInternalIterativeReduction, cmvTotal);
+    LogCmv(os, "Singular Extension", cmvSingularExtension, cmvTotal);
+    LogCmv(os, "Multi-Cut", cmvMultiCut, cmvTotal);
+    LogCmv(os, "SEE Pruning", cmvSeePruning, cmvTotal);
+    LogCmv(os, "First move cuts", cmvCutFirst, max(cmvCut, (int64_t)1));
     /* BUG! - Branch factor numerator should be cmvTotal minus number
        of iterative deepening/aspiration window loops we went through. But 
        it's a small enough number that it won't matter that much */
@@ -4,15 +4,19 @@
  * 
  *  FEN, EPD, and PGN file formats.
  * 
- *  A FEN can be read with just a BD, but EPD and PGN require a GAME.
+ *  A FEN can be read with just a BD, but EPD and PGN require a GAME, so
+ *  they are not available in the headless console build.
  */
 
 #include "chess.h"
 #include "resource.h"
 
-static bool FNextCh(istream& is, char& ch);
 static int IchFind(const string_view& s, char ch);
 
+#ifndef CONSOLE
+
+static bool FNextCh(istream& is, char& ch);
+
 /*
  *  linebreakbuf
  *
@@ -30,11 +34,15 @@ private:
     size_t cchMax;
 };
 
+#endif // CONSOLE
+
 /*
  *  FEN (Forsyth-Edwards Notation) file format and board representation, which 
  *  is a text-based standard simple representation of the chess board state.
  */
 
+#ifndef CONSOLE
+
 void GAME::InitFromFen(istream& is)
 {
     bd.InitFromFen(is);
@@ -49,6 +57,8 @@ void GAME::InitFromFen(const string& fen)
     NotifyBdChanged();
 }
 
+#endif // CONSOLE
+
 /* these constant parsing strings are all cleverly ordered to line up with
    the numerical definitions of various board, piece, and color values */
 
@@ -151,6 +161,9 @@ void BD::InitFromFenShared(istream& is)
         else if (sq < sqMax) {
             int icp = IcpUnused(cpc(ich), cpt(ich));
             aicpbd[cpc(ich)][icp] = IcpbdFromSq(sq);
+            AddPiece(sq, ich);
+            if (cpt(ich) == cptKing)
+                mpcpcsqKing[cpc(ich)] = sq;
             (*this)[sq++] = CPBD(ich, icp);   // otherwise the offset matches the value of the chess piece
         }
         else
@@ -273,6 +286,8 @@ string BD::FenEmpties(int& csqEmpty) const
     return to_string(csq);
 }
 
+#ifndef CONSOLE
+
 /*
  *  EPD file format
  * 
@@ -506,6 +521,8 @@ string GAME::EpdRender(void)
     return s;
 }
 
+#endif // CONSOLE
+
 /**
  *  Parses a Standard Algebraic Notation move string. Because the EPD spec 
  *  uses disambiguation, we need a current board state in order to parse 
@@ -597,7 +614,7 @@ Lookup:
     /* look up the move in the currrent legal move list */
     VMV vmv;
     MoveGen(vmv);
-    for (MV& mv : vmv) {
+    for (const MV& mv : vmv) {
         if (csMove) {
             if (csMove == mv.csMove)
                 return mv;
@@ -613,6 +630,8 @@ Lookup:
     throw ERRAPP(rssErrParseMoveNotAMove);
 }
 
+#ifndef CONSOLE
+
 /*
  *  PGN format
  * 
@@ -995,6 +1014,8 @@ void GAME::RenderPgnMoveList(ostream& os) const
     buf.sync();
 }
 
+#endif // CONSOLE
+
 /*
  *  BD::SDecodeMvu
  * 
@@ -1017,17 +1038,17 @@ string BD::SDecodeMvu(const MVU& mvuDecode) const
     int cmvAmbig = 0, cmvAmbigRank = 0, cmvAmbigFile = 0;
 
     /* castles */
-    if (mvuDecode.csMove & (csWhiteKing | csBlackKing)) {
+    if (mvuDecode.csMove() & (csWhiteKing | csBlackKing)) {
         s = "O-O";
         goto Checks;
     }
-    if (mvuDecode.csMove & (csWhiteQueen | csBlackQueen)) {
+    if (mvuDecode.csMove() & (csWhiteQueen | csBlackQueen)) {
         s = "O-O-O";
         goto Checks;
     }
 
     /* the piece moving */
-    cptMove = (CPT)(*this)[mvuDecode.sqFrom].cpt;
+    cptMove = (CPT)(*this)[mvuDecode.sqFrom()].cpt;
     if (cptMove != cptPawn)
         s += sParseBoard[cptMove];
 
@@ -1040,22 +1061,22 @@ string BD::SDecodeMvu(const MVU& mvuDecode) const
        disambiguated just rank or just file, but we'll do full square
        disambiguation. */
     for (MV mv : vmv) {
-        if (mv.sqTo != mvuDecode.sqTo || (*this)[mv.sqFrom].cpt != cptMove || mv.cptPromote != mvuDecode.cptPromote)
+        if (mv.sqTo != mvuDecode.sqTo() || (*this)[mv.sqFrom].cpt != cptMove || mv.cptPromote != mvuDecode.cptPromote())
             continue;
         cmvAmbig++;
-        cmvAmbigRank += ra(mvuDecode.sqFrom) == ra(mv.sqFrom);
-        cmvAmbigFile += fi(mvuDecode.sqFrom) == fi(mv.sqFrom);
+        cmvAmbigRank += ra(mvuDecode.sqFrom()) == ra(mv.sqFrom);
+        cmvAmbigFile += fi(mvuDecode.sqFrom()) == fi(mv.sqFrom);
     }
     assert(cmvAmbig >= 1 && cmvAmbigRank >= 1 && cmvAmbigFile >= 1);
     if (cmvAmbig > 1) {
         if (cmvAmbigRank > 1 && cmvAmbigFile > 1) {
-            s += 'a' + fi(mvuDecode.sqFrom);
-            s += '1' + ra(mvuDecode.sqFrom);
+            s += 'a' + fi(mvuDecode.sqFrom());
+            s += '1' + ra(mvuDecode.sqFrom());
         }
         else if (cmvAmbigFile > 1)
-            s += '1' + ra(mvuDecode.sqFrom);
+            s += '1' + ra(mvuDecode.sqFrom());
         else // use file disambiguation if it doesn't matter
-            s += 'a' + fi(mvuDecode.sqFrom);
+            s += 'a' + fi(mvuDecode.sqFrom());
     }
 
     /* capture */
@@ -1063,12 +1084,12 @@ string BD::SDecodeMvu(const MVU& mvuDecode) const
         s += 'x';
 
     /* destination square */
-    s += to_string(mvuDecode.sqTo);
+    s += to_string(mvuDecode.sqTo());
 
     /* promotion */
-    if (mvuDecode.cptPromote != cptNone) {
+    if (mvuDecode.cptPromote() != cptNone) {
         s += '=';
-        s += sParseBoard[mvuDecode.cptPromote];
+        s += sParseBoard[mvuDecode.cptPromote()];
     }
 
     /* mates */
@@ -1088,6 +1109,16 @@ Checks:
  *  utility stuff
  */
 
+static int IchFind(const string_view& s, char ch)
+{
+    size_t ich = s.find(ch);
+    if (ich == string::npos)
+        throw ERRAPP(rssErrFenParseUnexpectedChar, string(1, ch));
+    return static_cast<int>(ich);
+}
+
+#ifndef CONSOLE
+
 static bool FNextCh(istream& is, char& ch)
 {
     is.get(ch);
@@ -1100,14 +1131,6 @@ static bool FNextCh(istream& is, char& ch)
     return true;
 }
 
-static int IchFind(const string_view& s, char ch)
-{
-    size_t ich = s.find(ch);
-    if (ich == string::npos)
-        throw ERRAPP(rssErrFenParseUnexpectedChar, string(1, ch));
-    return static_cast<int>(ich);
-}
-
 /*
  *  linebreakbuf
  * 
@@ -1148,4 +1171,6 @@ int linebreakbuf::sync(void)
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+#endif // CONSOLE
@@ -9,7 +9,7 @@
 #include "chess.h"
 
 #define U64(u) u##ULL
-static const uint64_t ahaRandom[781] = {
+static constexpr uint64_t ahaRandom[781] = {
        U64(0x9D39247E33776D41), U64(0x2AF7398005AAA5C7), U64(0x44DB015024623547),
        U64(0x9C15F73E62A76AE2), U64(0x75834465489C0C89), U64(0x3290AC3A203001BF),
        U64(0x0FBBAD1F61042279), U64(0xE83A908FF2FB60CA), U64(0x0D7E765D58755C10),
@@ -273,10 +273,51 @@ static const uint64_t ahaRandom[781] = {
        U64(0xF8D626AAAF278509)
 };
 
-HA HaRandom(void)
-{
-    static int ihaRandom = 0;
-    assert(ihaRandom <= size(ahaRandom));
-    return ahaRandom[ihaRandom++];
-}
+/*
+ *  The Zobrist tables, laid out from the random numbers at compile time. 
+ * 
+ *  WARNING! - the order the random numbers are assigned is critical to 
+ *  making Polyglot lookup work: pieces (black before white, pawn to king, 
+ *  rank by rank), then the four castle rights, the en passant files, and 
+ *  finally the side to move. Don't change it!
+ */
+
+constexpr int ihaCastle = 768;
+constexpr int ihaEnPassant = ihaCastle + 4;
+constexpr int ihaToMove = ihaEnPassant + 8;
+static_assert(ihaToMove + 1 == size(ahaRandom));
+
+constinit const array<array<HA, cpMax>, sqMax> GENHA::ahaPiece = []() {
+    array<array<HA, cpMax>, sqMax> aha = {};
+    int iha = 0;
+    for (CPT cpt = cptPawn; cpt <= cptKing; ++cpt)
+        for (CPC cpc = cpcWhite; cpc <= cpcBlack; ++cpc)
+            for (int ra = 0; ra < raMax; ra++)
+                for (int fi = 0; fi < fiMax; fi++)
+                    aha[Sq(fi, ra)][Cp(~cpc, cpt)] = ahaRandom[iha++];
+    return aha;
+}();
+
+constinit const array<HA, 16> GENHA::ahaCastle = []() {
+    array<HA, 16> aha = {};
+    for (int cs = 0; cs < (int)aha.size(); cs++) {
+        if (cs & csWhiteKing)
+            aha[cs] ^= ahaRandom[ihaCastle + 0];
+        if (cs & csWhiteQueen)
+            aha[cs] ^= ahaRandom[ihaCastle + 1];
+        if (cs & csBlackKing)
+            aha[cs] ^= ahaRandom[ihaCastle + 2];
+        if (cs & csBlackQueen)
+            aha[cs] ^= ahaRandom[ihaCastle + 3];
+    }
+    return aha;
+}();
+
+constinit const array<HA, 8> GENHA::ahaEnPassant = []() {
+    array<HA, 8> aha = {};
+    for (int fi = 0; fi < fiMax; fi++)
+        aha[fi] = ahaRandom[ihaEnPassant + fi];
+    return aha;
+}();
 
+constinit const HA GENHA::haToMove = ahaRandom[ihaToMove];
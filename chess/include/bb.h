@@ -19,6 +19,7 @@
  */
 
 #include "framework.h"
+#include "bitops.h"
 
 /**
  *  @enum CPC
@@ -245,7 +246,8 @@ class BB
 public:
     constexpr BB(void) : grf(0) {}
     constexpr BB(SQ sq) : grf(1ULL << sq) {}
-    constexpr BB(uint64_t grf) : grf(grf) {}
+    template <unsigned_integral T> requires (sizeof(T) == sizeof(uint64_t))
+    constexpr BB(T grf) : grf(grf) {}
     constexpr BB& clear(void) noexcept { grf = 0; return *this; }
 
     /* standard bit opereations bitboard to bitboard */
@@ -285,10 +287,10 @@ public:
 
     /* information and extraction, square count, lowest and highest bit, removing
        lowest square */
-    int csq(void) const noexcept { return (int)__popcnt64(grf); }
-    SQ sqLow(void) const noexcept { assert(grf); DWORD sq; _BitScanForward64(&sq, grf); return (uint8_t)sq; }
-    SQ sqHigh(void) const noexcept { assert(grf); DWORD sq; _BitScanReverse64(&sq, grf); return (uint8_t)sq; }
-    void ClearLow(void) noexcept { /*grf &= grf - 1;*/ grf = _blsr_u64(grf); }
+    int csq(void) const noexcept { return CsqPopcount(grf); }
+    SQ sqLow(void) const noexcept { return (SQ)SqLowest(grf); }
+    SQ sqHigh(void) const noexcept { return (SQ)SqHighest(grf); }
+    void ClearLow(void) noexcept { grf = GrfClearLowest(grf); }
 
 public:
     uint64_t grf;
@@ -350,6 +352,11 @@ constexpr BB BbWest1(BB bb, int dsq) noexcept { return BbShift(bb - bbFileA, dsq
 constexpr BB BbEast1(BB bb, int dsq) noexcept { return BbShift(bb - bbFileH, dsq + dsqEast); }
 constexpr BB BbVertical(BB bb, int dsq) noexcept { return BbShift(bb, dsq); }
 
+constexpr BB BbPawnAttacks(BB bb, CPC cpc) noexcept
+{
+    return cpc == cpcWhite ? BbNorthWest1(bb) | BbNorthEast1(bb) : BbSouthWest1(bb) | BbSouthEast1(bb);
+}
+
 constexpr BB BbRankBack(CPC cpc) noexcept { return bbRank1 << ((7 * 8) & (-(int)cpc)); }
 constexpr BB BbRankPawnsInit(CPC cpc) noexcept { return bbRank2 << ((5 * 8) & (-(int)cpc)); }
 constexpr BB BbRankPawnsFirst(CPC cpc) noexcept { return bbRank3 << ((3 * 8) & (-(int)cpc)); }
@@ -391,6 +398,11 @@ constexpr DIR operator ++ (DIR& dir, int)
     return dirT;
 }
 
+constexpr DIR DirReverse(DIR dir) noexcept
+{
+    return static_cast<DIR>(dirNorthEast - dir);
+}
+
 constexpr DIR DirFromDraDfi(int dra, int dfi) noexcept
 {
     int dir = ((dra + 1) * 3 + dfi + 1);
@@ -415,13 +427,62 @@ constexpr int DfiFromDir(DIR dir) noexcept
         return (int)dir % 3 - 1;
 }
 
+/**
+ *  @struct     MAGIC
+ *  @brief      Slider attack table lookup for a single square
+ * 
+ *  @details    The occupied squares that can block a slider on this square
+ *              are hashed into an index into a table of precomputed attack
+ *              bitboards. On processors with a fast PEXT instruction, the
+ *              hash is just the blocker bits extracted into a dense index.
+ *              Otherwise we use "fancy" magic multiplication: the blocker 
+ *              bits times a magic number found at startup, with the top 
+ *              bits of the product used as the index. Which one we use is
+ *              decided once, from the CPU check at startup, and the tables
+ *              are laid out to match.
+ */
+
+struct MAGIC
+{
+    BB bbMask;          // squares that can block, excluding the edges
+    uint64_t grfMagic;  // magic multiplier
+    BB* pbbAttacks;     // this square's section of the attack table
+    int shift;          // 64 - number of bits in the mask
+
+    /* PEXT is only worth it when it's inlined */
+    static inline bool FPext(void) noexcept
+    {
+#ifdef BITOPS_BMI2_INLINE
+        return cpuf.fFastPext;
+#else
+        return false;
+#endif
+    }
+
+    inline unsigned Index(BB bbOccupied) const noexcept
+    {
+#ifdef BITOPS_BMI2_INLINE
+        if (FPext())
+            return (unsigned)GrfPextBmi2(bbOccupied.grf, bbMask.grf);
+#endif
+        return (unsigned)(((bbOccupied & bbMask).grf * grfMagic) >> shift);
+    }
+
+    inline BB BbAttacks(BB bbOccupied) const noexcept
+    {
+        return pbbAttacks[Index(bbOccupied)];
+    }
+};
+
 /**
  *  @class      MPBB
  *  @brief      Holds static attack bitboards for each square on the board.
  *
- *  @details    We could pre-compute these at compile-time, but we only need
- *              to do it once and it's fast, and that's a whoie lot of magic 
- *              binary numbers to type in.
+ *  @details    The fixed tables are generated at compile time, so they 
+ *              live in read-only data shared by every engine in the process.
+ *              The slider attack tables are laid out for PEXT or for magic
+ *              multiplication depending on the CPU we're running on, so they
+ *              still have to be built at startup.
  */
 
 class MPBB
@@ -434,14 +495,31 @@ public:
     BB BbPassedPawnAlley(SQ sq, CPC cpc) const noexcept { return mpsqbbPassedPawnAlley[sq - 8][static_cast<int>(cpc)]; }
     BB BbKingInner(SQ sq) const noexcept { return mpsqbbKingAttackInner[sq]; }
     BB BbKingOuter(SQ sq) const noexcept { return mpsqbbKingAttackOuter[sq]; }
+    BB BbBetween(SQ sq1, SQ sq2) const noexcept { return mpsqsqbbBetween[sq1][sq2]; }
+    BB BbLine(SQ sq1, SQ sq2) const noexcept { return mpsqsqbbLine[sq1][sq2]; }
+
+    BB BbBishopAttacks(SQ sq, BB bbOccupied) const noexcept { return mpsqmagicBishop[sq].BbAttacks(bbOccupied); }
+    BB BbRookAttacks(SQ sq, BB bbOccupied) const noexcept { return mpsqmagicRook[sq].BbAttacks(bbOccupied); }
+    BB BbQueenAttacks(SQ sq, BB bbOccupied) const noexcept { return BbBishopAttacks(sq, bbOccupied) | BbRookAttacks(sq, bbOccupied); }
+
+private:
+    BB BbSlideAttacks(SQ sq, DIR dir, BB bbOccupied) const noexcept;
+    void InitMagics(MAGIC mpsqmagic[], BB abbAttacks[], const DIR adir[4]) noexcept;
 
 private:
-    BB mpsqdirbbSlide[64][8];
-    BB mpsqbbKing[64];
-    BB mpsqbbKnight[64];
-    BB mpsqbbPassedPawnAlley[48][2];
-    BB mpsqbbKingAttackInner[64];
-    BB mpsqbbKingAttackOuter[64];
+    static const array<array<BB, 8>, 64> mpsqdirbbSlide;
+    static const array<BB, 64> mpsqbbKing;
+    static const array<BB, 64> mpsqbbKnight;
+    static const array<array<BB, 2>, 48> mpsqbbPassedPawnAlley;
+    static const array<BB, 64> mpsqbbKingAttackInner;
+    static const array<BB, 64> mpsqbbKingAttackOuter;
+    static const array<array<BB, 64>, 64> mpsqsqbbBetween;  // squares strictly between two squares on a line
+    static const array<array<BB, 64>, 64> mpsqsqbbLine;     // the entire line through two squares
+
+    MAGIC mpsqmagicBishop[64];
+    MAGIC mpsqmagicRook[64];
+    BB abbBishopAttacks[5248];
+    BB abbRookAttacks[102400];
 };
 
 extern MPBB mpbb;
@@ -0,0 +1,296 @@
+#pragma once
+
+/**
+ *  @file       bitops.h
+ *  @brief      Portable bit manipulation primitives
+ *
+ *  @details    The handful of bit twiddling operations the bitboard code
+ *              depends on: population count, lowest and highest set bit,
+ *              clearing the lowest bit, and parallel bit extract/deposit.
+ *
+ *              The basic operations come from C++20 <bit>, which every
+ *              compiler turns into the native instruction when the target
+ *              architecture has one, and into a library call when it 
+ *              doesn't. MSVC gets its intrinsics directly, because its <bit>
+ *              implementation adds a runtime CPU check to every call. The
+ *              POPCNT instruction isn't in the x64 baseline, so on MSVC we 
+ *              check cpuf.fPopcnt the same way PEXT is dispatched, and fall
+ *              back to software versions. MSVC builds for other processors
+ *              use the software versions.
+ *
+ *              PEXT and PDEP are only in BMI2, which isn't available on older
+ *              processors, and is microcoded and painfully slow on AMD parts
+ *              before Zen 3. We detect the CPU once at startup and callers
+ *              check cpuf.fFastPext to decide which path to take.
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "framework.h"
+#include <bit>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BITOPS_X64
+#endif
+
+/**
+ *  @class      CPUF
+ *  @brief      CPU features relevant to the bitboard code
+ *
+ *  @details    Filled in once at startup. The global is an inline variable
+ *              so it is initialized before any static tables that are defined
+ *              later in a file that includes this header.
+ */
+
+class CPUF
+{
+public:
+    CPUF(void);
+
+    bool fPopcnt = false;
+    bool fBmi1 = false;
+    bool fBmi2 = false;
+    bool fFastPext = false;    // BMI2 is present and not microcoded
+    string sVendor;
+};
+
+inline const CPUF cpuf;
+
+/*
+ *  population count, bit scan, and clear lowest bit
+ */
+
+/**
+ *  @fn         int CsqPopcountSoft(uint64_t grf)
+ *  @brief      Software population count
+ *
+ *  @details    Adds up adjacent bits in parallel, then sums the bytes with
+ *              a multiply.
+ */
+
+constexpr int CsqPopcountSoft(uint64_t grf) noexcept
+{
+    grf = grf - ((grf >> 1) & 0x5555555555555555ULL);
+    grf = (grf & 0x3333333333333333ULL) + ((grf >> 2) & 0x3333333333333333ULL);
+    grf = (grf + (grf >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((grf * 0x0101010101010101ULL) >> 56);
+}
+
+/**
+ *  @fn         int SqLowestSoft(uint64_t grf)
+ *  @brief      Software lowest set bit
+ *
+ *  @details    Isolates the lowest bit and multiplies by a de Bruijn 
+ *              sequence, which leaves a unique 6-bit index in the top bits.
+ */
+
+inline constexpr int mpisqDeBruijn[64] = {
+     0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+    62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+    63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+    46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+};
+
+constexpr int SqLowestSoft(uint64_t grf) noexcept
+{
+    assert(grf);
+    return mpisqDeBruijn[((grf & (0 - grf)) * 0x03f79d71b4cb0a89ULL) >> 58];
+}
+
+/**
+ *  @fn         int SqHighestSoft(uint64_t grf)
+ *  @brief      Software highest set bit
+ *
+ *  @details    Smears the highest bit into every bit below it and counts
+ *              them.
+ */
+
+constexpr int SqHighestSoft(uint64_t grf) noexcept
+{
+    assert(grf);
+    grf |= grf >> 1;
+    grf |= grf >> 2;
+    grf |= grf >> 4;
+    grf |= grf >> 8;
+    grf |= grf >> 16;
+    grf |= grf >> 32;
+    return CsqPopcountSoft(grf) - 1;
+}
+
+#if defined(_MSC_VER) && defined(BITOPS_X64)
+#include <intrin.h>
+
+inline int CsqPopcount(uint64_t grf) noexcept
+{
+    if (cpuf.fPopcnt)
+        return (int)__popcnt64(grf);
+    return CsqPopcountSoft(grf);
+}
+
+inline int SqLowest(uint64_t grf) noexcept
+{
+    assert(grf);
+    DWORD sq;
+    _BitScanForward64(&sq, grf);
+    return (int)sq;
+}
+
+inline int SqHighest(uint64_t grf) noexcept
+{
+    assert(grf);
+    DWORD sq;
+    _BitScanReverse64(&sq, grf);
+    return (int)sq;
+}
+
+#elif defined(_MSC_VER)
+
+inline int CsqPopcount(uint64_t grf) noexcept
+{
+    return CsqPopcountSoft(grf);
+}
+
+inline int SqLowest(uint64_t grf) noexcept
+{
+    return SqLowestSoft(grf);
+}
+
+inline int SqHighest(uint64_t grf) noexcept
+{
+    return SqHighestSoft(grf);
+}
+
+#else
+
+constexpr int CsqPopcount(uint64_t grf) noexcept
+{
+    return std::popcount(grf);
+}
+
+constexpr int SqLowest(uint64_t grf) noexcept
+{
+    assert(grf);
+    return std::countr_zero(grf);
+}
+
+constexpr int SqHighest(uint64_t grf) noexcept
+{
+    assert(grf);
+    return 63 - std::countl_zero(grf);
+}
+
+#endif
+
+/* compiles to BLSR when BMI1 is enabled */
+
+constexpr uint64_t GrfClearLowest(uint64_t grf) noexcept
+{
+    return grf & (grf - 1);
+}
+
+/*
+ *  parallel bit extract and deposit
+ */
+
+/**
+ *  @fn         uint64_t GrfPextSoft(uint64_t grf, uint64_t grfMask)
+ *  @brief      Software parallel bit extract
+ *
+ *  @details    Gathers the bits of grf selected by grfMask into the low
+ *              order bits of the result. Loops once per bit in the mask.
+ */
+
+constexpr uint64_t GrfPextSoft(uint64_t grf, uint64_t grfMask) noexcept
+{
+    uint64_t grfRet = 0;
+    for (uint64_t bit = 1; grfMask; bit <<= 1) {
+        if (grf & grfMask & (0 - grfMask))
+            grfRet |= bit;
+        grfMask = GrfClearLowest(grfMask);
+    }
+    return grfRet;
+}
+
+/**
+ *  @fn         uint64_t GrfPdepSoft(uint64_t grf, uint64_t grfMask)
+ *  @brief      Software parallel bit deposit
+ *
+ *  @details    Scatters the low order bits of grf into the bit positions set
+ *              in grfMask. The inverse of GrfPextSoft.
+ */
+
+constexpr uint64_t GrfPdepSoft(uint64_t grf, uint64_t grfMask) noexcept
+{
+    uint64_t grfRet = 0;
+    for (uint64_t bit = 1; grfMask; bit <<= 1) {
+        if (grf & bit)
+            grfRet |= grfMask & (0 - grfMask);
+        grfMask = GrfClearLowest(grfMask);
+    }
+    return grfRet;
+}
+
+#ifdef BITOPS_X64
+
+/* hardware versions; only call these when cpuf.fBmi2 is set. MSVC lets us use
+   the intrinsics anywhere, and so does GCC when the whole build targets BMI2.
+   Otherwise GCC and Clang won't inline the intrinsics into code that isn't 
+   compiled for BMI2, but the assembler takes the instruction regardless, so 
+   we use inline assembly. Either way they inline into the slider lookups, and 
+   the CPU check at startup picks the path */
+
+#define BITOPS_BMI2_INLINE
+
+#if defined(_MSC_VER) || defined(__BMI2__)
+#include <immintrin.h>
+
+inline uint64_t GrfPextBmi2(uint64_t grf, uint64_t grfMask) noexcept
+{
+    return _pext_u64(grf, grfMask);
+}
+
+inline uint64_t GrfPdepBmi2(uint64_t grf, uint64_t grfMask) noexcept
+{
+    return _pdep_u64(grf, grfMask);
+}
+#else
+inline uint64_t GrfPextBmi2(uint64_t grf, uint64_t grfMask) noexcept
+{
+    uint64_t grfRet;
+    __asm__("pextq %2, %1, %0" : "=r"(grfRet) : "r"(grf), "rm"(grfMask));
+    return grfRet;
+}
+
+inline uint64_t GrfPdepBmi2(uint64_t grf, uint64_t grfMask) noexcept
+{
+    uint64_t grfRet;
+    __asm__("pdepq %2, %1, %0" : "=r"(grfRet) : "r"(grf), "rm"(grfMask));
+    return grfRet;
+}
+#endif
+
+#endif
+
+/**
+ *  @fn         uint64_t GrfPext(uint64_t grf, uint64_t grfMask)
+ *  @brief      Parallel bit extract using the fastest method on this CPU
+ */
+
+inline uint64_t GrfPext(uint64_t grf, uint64_t grfMask) noexcept
+{
+#ifdef BITOPS_X64
+    if (cpuf.fFastPext)
+        return GrfPextBmi2(grf, grfMask);
+#endif
+    return GrfPextSoft(grf, grfMask);
+}
+
+inline uint64_t GrfPdep(uint64_t grf, uint64_t grfMask) noexcept
+{
+#ifdef BITOPS_X64
+    if (cpuf.fFastPext)
+        return GrfPdepBmi2(grf, grfMask);
+#endif
+    return GrfPdepSoft(grf, grfMask);
+}
@@ -16,6 +16,7 @@
 #include "bb.h"
 class BD;
 class AI;
+class HD;
 
 /**
  *  @enum TCP
@@ -88,6 +89,32 @@ constexpr CP cpEmpty = Cp(cpcEmpty, cptNone);;
 constexpr CP cpInvalid = Cp(cpcInvalid, cptMax);
 constexpr CP cpMax = 16;
 
+/**
+ *  @typedef MK
+ *  @brief Material key
+ * 
+ *  The count of each kind of piece on the board, packed 4 bits per piece 
+ *  into a 64-bit integer, indexed by CP. Adding and removing pieces is
+ *  just adding and subtracting the piece's unit, and a particular material
+ *  balance can be recognized with a single compare, which is handy for 
+ *  draw detection and picking endgame evaluators.
+ */
+
+typedef uint64_t MK;
+
+constexpr MK MkFromCp(CP cp, int ccp = 1) noexcept
+{
+    return (MK)ccp << (cp * 4);
+}
+
+constexpr int CcpFromMk(MK mk, CP cp) noexcept
+{
+    return (int)((mk >> (cp * 4)) & 0x0f);
+}
+
+constexpr MK mkKings = MkFromCp(cpWhiteKing) | MkFromCp(cpBlackKing);
+static_assert(CcpFromMk(mkKings + MkFromCp(cpBlackQueen, 9), cpBlackQueen) == 9);
+
 /**
  *  @struct CPBD
  *  @brief The computer piece as represented in the board.
@@ -249,7 +276,6 @@ typedef uint64_t HA;
 class GENHA
 {
 public:
-    GENHA(void);
     HA HaFromBd(const BD& bd) const;
     HA HaPolyglotFromBd(const BD& bd) const;
     bool FEnPassantPolyglot(const BD& bd) const;
@@ -292,17 +318,20 @@ public:
         ha ^= ahaEnPassant[fi(sq)];
     }
 
+    static HA HaPiece(SQ sq, CP cp) noexcept { return ahaPiece[sq][cp]; }
+    static HA HaToMove(void) noexcept { return haToMove; }
+
 private:
-    /* hash values in convenient form to quickly keep hash value up-to-date */
+    /* hash values in convenient form to quickly keep hash value up-to-date;
+       these are laid out from the Polyglot random numbers at compile time */
 
-    static HA ahaPiece[sqMax][cpMax];
-    static HA ahaCastle[16];
-    static HA ahaEnPassant[8];
-    static HA haToMove;
+    static const array<array<HA, cpMax>, sqMax> ahaPiece;
+    static const array<HA, 16> ahaCastle;
+    static const array<HA, 8> ahaEnPassant;
+    static const HA haToMove;
 };
 
 extern GENHA genha;
-HA HaRandom(void);
 
 /**
  *  @typedef EV
@@ -344,6 +373,55 @@ constexpr bool FEvIsInterrupt(EV ev) noexcept
 
 string to_string(EV ev);
 
+/**
+ *  @class EVP
+ *  @brief A middle game and end game evaluation pair
+ *
+ *  @details    Tapered evaluation terms have separate values for the middle
+ *              game and the end game, which we blend by game phase at the end
+ *              of the evaluation. Both halves are packed into a single 32-bit
+ *              integer, with the end game in the high half, so adding or
+ *              scaling a term works on both halves with one operation. The
+ *              low half is signed, so extracting the high half has to round
+ *              away the borrow it may have taken.
+ */
+
+class EVP
+{
+public:
+    constexpr EVP(void) noexcept : grf(0) {}
+    constexpr EVP(EV evMid, EV evEnd) noexcept :
+        grf((int32_t)((uint32_t)(int32_t)evEnd << 16) + evMid)
+    {
+    }
+
+    constexpr EV evMid(void) const noexcept { return (EV)(uint16_t)(uint32_t)grf; }
+    constexpr EV evEnd(void) const noexcept { return (EV)(uint16_t)((uint32_t)(grf + 0x8000) >> 16); }
+
+    constexpr EVP operator + (EVP evp) const noexcept { return EvpFromGrf(grf + evp.grf); }
+    constexpr EVP operator - (EVP evp) const noexcept { return EvpFromGrf(grf - evp.grf); }
+    constexpr EVP operator - (void) const noexcept { return EvpFromGrf(-grf); }
+    constexpr EVP operator * (int w) const noexcept { return EvpFromGrf(grf * w); }
+    constexpr EVP& operator += (EVP evp) noexcept { grf += evp.grf; return *this; }
+    constexpr EVP& operator -= (EVP evp) noexcept { grf -= evp.grf; return *this; }
+    constexpr bool operator == (EVP evp) const noexcept { return grf == evp.grf; }
+    constexpr bool operator != (EVP evp) const noexcept { return grf != evp.grf; }
+
+private:
+    static constexpr EVP EvpFromGrf(int32_t grf) noexcept
+    {
+        EVP evp;
+        evp.grf = grf;
+        return evp;
+    }
+
+    int32_t grf;
+};
+
+static_assert(EVP(-3, 5).evMid() == -3 && EVP(-3, 5).evEnd() == 5);
+static_assert((EVP(-3, -5) + EVP(7, 1)).evEnd() == -4);
+static_assert((EVP(10, -20) * -3).evMid() == -30 && (EVP(10, -20) * -3).evEnd() == 60);
+
 /**
  *  @enum EVENUM
  * 
@@ -351,7 +429,7 @@ string to_string(EV ev);
  *  cause an alpha-beta cut.
  */
 
-enum class EVENUM
+enum class EVENUM : uint8_t
 {
     None = 0,
     PV = 1,
@@ -372,9 +450,111 @@ constexpr EVENUM& operator ++ (EVENUM& evenum) noexcept
 
 string to_string(EVENUM evenum) noexcept;
 
+/**
+ *  @enum GEN
+ *  @brief The kinds of moves the legal move generator can produce
+ */
+
+enum class GEN
+{
+    All = 0,    // every legal move
+    Noisy = 1,  // captures only, including en passant
+    Quiet = 2   // everything that isn't a capture
+};
+
+/**
+ *  @class MVC
+ *  @brief A compact chess move, packed into 16 bits
+ * 
+ *  Used wherever we store a lot of moves: the move list, the transposition
+ *  table, killers, and the game history. The from and to squares take 6 bits 
+ *  each, the promotion piece 3 bits, and the high bit marks castles. Which 
+ *  castle it is comes from the file the king ends up on. The nil move is 
+ *  all zeros, which can't be a real move.
+ */
+
+class MV;
+
+class MVC
+{
+public:
+    constexpr MVC(void) noexcept : grf(0) 
+    {
+    }
+
+    constexpr MVC(SQ sqFrom, SQ sqTo, CPT cptPromote = cptNone, CS csMove = csNone) noexcept :
+        grf((uint16_t)(sqFrom | (sqTo << 6) | (cptPromote << 12) | ((csMove != csNone) << 15)))
+    {
+    }
+
+    constexpr explicit MVC(const MV& mv) noexcept;
+
+    constexpr SQ sqFrom(void) const noexcept { return (SQ)(grf & 0x3f); }
+    constexpr SQ sqTo(void) const noexcept { return (SQ)((grf >> 6) & 0x3f); }
+    constexpr CPT cptPromote(void) const noexcept { return (CPT)((grf >> 12) & 0x07); }
+    constexpr CS csMove(void) const noexcept 
+    { 
+        if (!(grf & 0x8000))
+            return csNone;
+        return fi(sqTo()) == fiG ? csKing : csQueen;
+    }
+    constexpr bool fIsNil(void) const noexcept { return grf == 0; }
+
+    constexpr bool operator == (const MVC& mvc) const noexcept { return grf == mvc.grf; }
+    constexpr bool operator != (const MVC& mvc) const noexcept { return grf != mvc.grf; }
+
+public:
+    uint16_t grf;
+};
+
+static_assert(sizeof(MVC) == 2);
+
+/**
+ *  @class CUCKOO
+ *  @brief Table of the hash differences of every reversible move
+ * 
+ *  @details    For every non-pawn piece and every pair of squares it can move
+ *              between on an empty board, the XOR of the piece on the two 
+ *              squares and the side to move. That's exactly how much the 
+ *              hash changes when the piece makes that move, so XORing two 
+ *              positions' hashes and finding the result in this table tells 
+ *              us one move gets from one position to the other. There are 
+ *              3668 such moves, stored in a cuckoo hash table with two 
+ *              possible slots for each one.
+ */
+
+class CUCKOO
+{
+public:
+    CUCKOO(void);
+    bool FLookup(HA haMove, MVC& mvc) const noexcept
+    {
+        int iha = Iha1(haMove);
+        if (ahaMove[iha] != haMove) {
+            iha = Iha2(haMove);
+            if (ahaMove[iha] != haMove)
+                return false;
+        }
+        mvc = amvc[iha];
+        return true;
+    }
+
+private:
+    static constexpr int ihaMax = 8192;
+    static constexpr int Iha1(HA ha) noexcept { return (int)(ha & (ihaMax - 1)); }
+    static constexpr int Iha2(HA ha) noexcept { return (int)((ha >> 16) & (ihaMax - 1)); }
+    HA ahaMove[ihaMax];
+    MVC amvc[ihaMax];
+};
+
+extern CUCKOO cuckoo;
+
 /**
  *  @class MV
  *  @brief The chess move on the board. 
+ * 
+ *  The full move, along with the information we collect about it while 
+ *  we search. This is what we hand around; MVC is what we store.
  */
 
 class MV
@@ -421,6 +601,15 @@ public:
     {
     }
 
+    constexpr MV(MVC mvc, EV ev = 0) noexcept :
+        sqFrom(mvc.fIsNil() ? sqNil : mvc.sqFrom()),
+        sqTo(mvc.fIsNil() ? sqNil : mvc.sqTo()),
+        cptPromote(mvc.cptPromote()),
+        csMove(mvc.csMove()),
+        ev(ev)
+    {
+    }
+
     constexpr bool fIsNil(void) const noexcept
     {
         return sqFrom == sqNil;
@@ -453,18 +642,24 @@ public:
 
 string to_string(const MV& mv) noexcept;
 
+constexpr MVC::MVC(const MV& mv) noexcept :
+    MVC(mv.fIsNil() ? MVC() : MVC(mv.sqFrom, mv.sqTo, mv.cptPromote, mv.csMove))
+{
+}
+
 /**
  *  @class MVU
  *  @brief Move with undo information to take back a MakeMv
  */
 
-class MVU : public MV
+class MVU : public MVC
 {
 public:
-    inline MVU(MV mv, const BD& bd);
+    inline MVU(const MV& mv, const BD& bd);
 
     /* undo information saved on MakeMv */
     CP cpTake;
+    int8_t icpTake;     // piece table slot the captured piece came from
     CS csSav;
     SQ sqEnPassantSav;
     uint8_t cmvNoCaptureOrPawnSav;
@@ -482,6 +677,11 @@ inline const MV mvNil;
  *  be plenty.
  *
  *  Has limited functionality. Basically only Iteration, indexing, and emplace_back.
+ * 
+ *  The moves are stored compactly, with the scores and evaluation types the
+ *  smart iterator sorts on kept in separate parallel arrays, so the sort 
+ *  scans tightly packed scores and only moves a few bytes around when it 
+ *  swaps. Indexing and plain iteration return full MVs by value.
  */
 
 #pragma warning(push)
@@ -490,60 +690,60 @@ inline const MV mvNil;
 class VMV {
 
 public:
-    class iterator
-    {
-    public:
-        inline iterator(MV* pmv) noexcept : pmvCur(pmv) {}
-        inline MV& operator * () const noexcept { return *pmvCur; }
-        inline MV* operator -> () const noexcept { return pmvCur; }
-        inline iterator& operator ++ () noexcept { ++pmvCur; return *this; }
-        inline iterator operator ++ (int) noexcept { iterator it = *this;  pmvCur++; return it; }
-        inline bool operator != (const iterator& it) const noexcept { return pmvCur != it.pmvCur; }
-        inline bool operator == (const iterator& it) const noexcept { return pmvCur == it.pmvCur; }
-    protected:
-        MV* pmvCur;
-    };
-
     class citerator
     {
     public:
-        inline citerator(const MV* pmv) noexcept : pmvCur(pmv) {}
-        inline const MV& operator * () const noexcept { return *pmvCur; }
-        inline const MV* operator -> () const noexcept { return pmvCur; }
-        inline citerator& operator ++ () noexcept { ++pmvCur; return *this; }
-        inline citerator operator ++ (int) noexcept { citerator it = *this;  pmvCur++; return it; }
-        inline bool operator != (const citerator& it) const noexcept { return pmvCur != it.pmvCur; }
-        inline bool operator == (const citerator& it) const noexcept { return pmvCur == it.pmvCur; }
+        inline citerator(const VMV* pvmv, int imv) noexcept : pvmv(pvmv), imvCur(imv) {}
+        inline MV operator * () const noexcept { return (*pvmv)[imvCur]; }
+        inline citerator& operator ++ () noexcept { ++imvCur; return *this; }
+        inline citerator operator ++ (int) noexcept { citerator it = *this;  imvCur++; return it; }
+        inline bool operator != (const citerator& it) const noexcept { return imvCur != it.imvCur; }
+        inline bool operator == (const citerator& it) const noexcept { return imvCur == it.imvCur; }
     protected:
-        const MV* pmvCur;
+        const VMV* pvmv;
+        int imvCur;
     };
 
-    class siterator : public iterator
+    /* the smart iterator hands out a reference to a copy of the current move, 
+       so the search can annotate it */
+    class siterator
     {
+        friend class VMV;
     public:
-        inline siterator(AI* pai, BD* pbd, MV* pmv, MV* pmvMac) noexcept;
-        inline siterator& operator ++ () noexcept;
-        inline siterator operator ++ (int) noexcept { siterator it = *this; ++(*this); return it; }
+        siterator(AI* pai, BD* pbd, VMV* pvmv, int imv) noexcept;
+        inline MV& operator * () noexcept { return mvCur; }
+        inline MV* operator -> () noexcept { return &mvCur; }
+        siterator& operator ++ () noexcept;
+        inline bool operator != (const siterator& sit) const noexcept { return imvCur != sit.imvCur; }
+        inline bool operator == (const siterator& sit) const noexcept { return imvCur == sit.imvCur; }
     private:
         void NextBestScore(void) noexcept;
         void InitEvEnum(void) noexcept;
+        void GenStage(GEN gen) noexcept;
+        void AddStaged(const MV& mv) noexcept;
+        bool FStaged(MVC mvc) const noexcept;
 
         AI* pai;
         BD* pbd;
+        VMV* pvmv;
+        int imvCur;
+        MV mvCur;
         EVENUM evenum = EVENUM::None;
-        MV* pmvMac;
+
+        /* moves we add before their generation stage, which we must not add
+           again when the stage is generated */
+        static const int cmvStagedMax = 8;
+        MVC amvcStaged[cmvStagedMax];
+        int cmvStaged = 0;
     };
 
     /* simple iterator */
     inline int size(void) const noexcept { return imvMac; }
     inline bool empty(void) const noexcept { return imvMac == 0; }
-    inline MV& operator [] (int imv) noexcept { return reinterpret_cast<MV*>(amv)[imv]; }
-    inline const MV& operator [] (int imv) const noexcept { return reinterpret_cast<const MV*>(amv)[imv]; }
-    inline iterator begin(void) noexcept { return iterator(&reinterpret_cast<MV*>(amv)[0]); }
-    inline iterator end(void) noexcept { return iterator(&reinterpret_cast<MV*>(amv)[imvMac]); }
-    inline citerator begin(void) const noexcept { return citerator(&reinterpret_cast<const MV*>(amv)[0]); }
-    inline citerator end(void) const noexcept { return citerator(&reinterpret_cast<const MV*>(amv)[imvMac]); }
-    inline void clear(void) noexcept { imvMac = 0; }
+    inline MV operator [] (int imv) const noexcept { return MV(amvc[imv], mpimvev[imv]); }
+    inline citerator begin(void) const noexcept { return citerator(this, 0); }
+    inline citerator end(void) const noexcept { return citerator(this, imvMac); }
+    inline void clear(void) noexcept { imvMac = 0; fStaged = false; }
     inline void resize(int cmv) noexcept { imvMac = cmv; }
     inline void reserve(int cmv) noexcept { assert(cmv == cmvGenMax); }   // we're fixed size 
 
@@ -555,9 +755,14 @@ public:
     template <typename... ARGS>
     inline void emplace_back(ARGS&&... args) noexcept
     {
-        new (&reinterpret_cast<MV*>(amv)[imvMac]) MV(forward<ARGS>(args)...);
+        assert(imvMac < cmvGenMax);
+        if constexpr (is_constructible_v<MVC, ARGS...> && !(is_same_v<remove_cvref_t<ARGS>, int8_t> || ...))
+            amvc[imvMac] = MVC(forward<ARGS>(args)...);
+        else
+            amvc[imvMac] = MVC(MV(forward<ARGS>(args)...));
+        mpimvev[imvMac] = 0;
+        mpimvevenum[imvMac] = EVENUM::None;
         ++imvMac;
-        assert(imvMac <= cmvGenMax);
     }
 
     inline void pop_back(void) noexcept
@@ -566,24 +771,164 @@ public:
         --imvMac;
     }
 
-    inline MV& back(void) noexcept
+    inline MV back(void) const noexcept
     {
         assert(imvMac > 0);
-        return reinterpret_cast<MV*>(amv)[imvMac - 1];
+        return (*this)[imvMac - 1];
     }
 
-    inline VMV::siterator InitMv(BD& bd, AI& ai) noexcept;
+    inline VMV::siterator InitMv(BD& bd, AI& ai, const HD* phd = nullptr) noexcept;
+    inline VMV::siterator InitMvStaged(BD& bd, AI& ai, const HD* phd = nullptr) noexcept;
     inline bool FGetMv(VMV::siterator& sit, BD& bd) noexcept;
     inline void NextMv(VMV::siterator& sit) noexcept;
     int cmvLegal = 0;
+    bool fStaged = false;   // moves are generated by the smart iterator as needed
+    const HD* phd = nullptr;    // search stack entry of the node, for move ordering
     static const int cmvGenMax = 256;
 
 private:
-    alignas(MV) uint8_t amv[cmvGenMax * sizeof(MV)];
+    void Swap(int imv1, int imv2) noexcept;
+
+    MVC amvc[cmvGenMax];
+    EV mpimvev[cmvGenMax];
+    EVENUM mpimvevenum[cmvGenMax];
     int16_t imvMac = 0;
 };
 #pragma warning(pop)
 
+/**
+ *  @class VMVU
+ *  @brief The move history of a board
+ *
+ *  @details    Split into two parts. The older moves of the game live in an
+ *              immutable vector that is shared by every copy of the board,
+ *              and the most recent moves, which includes every move made
+ *              during a search, go into a fixed array inside the board. So
+ *              copying a board only copies the handful of recent moves, and
+ *              making and undoing moves in the search never allocates.
+ *
+ *              When the fixed array fills up, which only happens when a long
+ *              game is played on the same board, the array is folded into a
+ *              new shared prefix. Undoing back into the prefix just shortens
+ *              our view of it, so the shared vector is never modified.
+ *
+ *              Has the same interface as the subset of vector we use on the
+ *              move history.
+ *
+ *              We also keep a count of the saved position hashes, bucketed 
+ *              by the high bits of the hash. A bucket with no entries means 
+ *              the position has never occurred, so most repetition tests 
+ *              never have to walk the history.
+ */
+
+class VMVU
+{
+public:
+    class citerator
+    {
+    public:
+        inline citerator(const VMVU* pvmvu, int imvu) noexcept : pvmvu(pvmvu), imvuCur(imvu) {}
+        inline const MVU& operator * () const noexcept { return (*pvmvu)[imvuCur]; }
+        inline citerator& operator ++ () noexcept { ++imvuCur; return *this; }
+        inline bool operator != (const citerator& it) const noexcept { return imvuCur != it.imvuCur; }
+        inline bool operator == (const citerator& it) const noexcept { return imvuCur == it.imvuCur; }
+    private:
+        const VMVU* pvmvu;
+        int imvuCur;
+    };
+
+    VMVU(void) noexcept {}
+
+    VMVU(const VMVU& vmvu) noexcept :
+        pvmvuPrefix(vmvu.pvmvuPrefix),
+        cmvuPrefix(vmvu.cmvuPrefix),
+        cmvuRecent(vmvu.cmvuRecent)
+    {
+        copy(vmvu.amvuRecent, vmvu.amvuRecent + cmvuRecent, amvuRecent);
+        copy(vmvu.mpihacmvu, vmvu.mpihacmvu + cihaFilter, mpihacmvu);
+    }
+
+    VMVU& operator = (const VMVU& vmvu) noexcept
+    {
+        if (this != &vmvu) {
+            pvmvuPrefix = vmvu.pvmvuPrefix;
+            cmvuPrefix = vmvu.cmvuPrefix;
+            cmvuRecent = vmvu.cmvuRecent;
+            copy(vmvu.amvuRecent, vmvu.amvuRecent + cmvuRecent, amvuRecent);
+            copy(vmvu.mpihacmvu, vmvu.mpihacmvu + cihaFilter, mpihacmvu);
+        }
+        return *this;
+    }
+
+    inline size_t size(void) const noexcept { return cmvuPrefix + cmvuRecent; }
+    inline bool empty(void) const noexcept { return size() == 0; }
+
+    inline const MVU& operator [] (size_t imvu) const noexcept
+    {
+        assert(imvu < size());
+        if (imvu >= cmvuPrefix)
+            return amvuRecent[imvu - cmvuPrefix];
+        return (*pvmvuPrefix)[imvu];
+    }
+
+    inline const MVU& back(void) const noexcept
+    {
+        return (*this)[size() - 1];
+    }
+
+    inline citerator begin(void) const noexcept { return citerator(this, 0); }
+    inline citerator end(void) const noexcept { return citerator(this, (int)size()); }
+
+    template <typename... ARGS>
+    inline MVU& emplace_back(ARGS&&... args) noexcept
+    {
+        if (cmvuRecent == cmvuRecentMax) [[unlikely]]
+            Fold();
+        MVU* pmvu = new (&amvuRecent[cmvuRecent++]) MVU(forward<ARGS>(args)...);
+        mpihacmvu[IhaFilter(pmvu->haSav)]++;
+        return *pmvu;
+    }
+
+    inline void pop_back(void) noexcept
+    {
+        assert(!empty());
+        mpihacmvu[IhaFilter(back().haSav)]--;
+        if (cmvuRecent > 0)
+            cmvuRecent--;
+        else
+            cmvuPrefix--;
+    }
+
+    inline void clear(void) noexcept
+    {
+        pvmvuPrefix.reset();
+        cmvuPrefix = 0;
+        cmvuRecent = 0;
+        fill(mpihacmvu, mpihacmvu + cihaFilter, 0);
+    }
+
+    void Fold(void);
+
+    /* false if the position with this hash is definitely not in the history */
+    inline bool FMayContain(HA ha) const noexcept
+    {
+        return mpihacmvu[IhaFilter(ha)] != 0;
+    }
+
+private:
+    static constexpr int cihaFilter = 1024;
+    static constexpr int IhaFilter(HA ha) noexcept { return (int)(ha >> 54); }
+    uint16_t mpihacmvu[cihaFilter] = {};
+
+    static constexpr int cmvuRecentMax = 256;   // enough for the deepest search
+    shared_ptr<const vector<MVU>> pvmvuPrefix;
+    uint32_t cmvuPrefix = 0;
+    uint32_t cmvuRecent = 0;
+    union {     // left unconstructed, so copying a board only touches the moves in use
+        MVU amvuRecent[cmvuRecentMax];
+    };
+};
+
 /**
  *  We use the nmv type to represent a move number, which starts at 1 and is
  *  the same as the number written in a chess move list. So both black and
@@ -615,6 +960,11 @@ constexpr int phaseMin = 0;
 constexpr int phaseMidFirst = phaseMin + 2*phaseMinor;
 constexpr int phaseEndFirst = phaseMax - 2*phaseQueen;
 
+/* tables the board uses to keep its running evaluation totals */
+extern const int mpcptphase[cptMax];
+extern const EV mpcptevMaterial[cptMax];
+extern const array<array<EVP, sqMax>, cpMax> mpcpsqevp;
+
 class BD
 {
     friend class WNBD;
@@ -647,10 +997,15 @@ public:
 
     inline SQ SqKing(CPC cpc) const noexcept
     {
-        int8_t icpbd = IcpbdFindKing(cpc);
-        return SqFromIcpbd(icpbd);
+        return mpcpcsqKing[cpc];
     }
 
+    /* bitboards of the pieces, kept in sync with the mailbox */
+    inline BB BbOccupied(void) const noexcept { return mpcpcbb[cpcWhite] | mpcpcbb[cpcBlack]; }
+    inline BB BbColor(CPC cpc) const noexcept { return mpcpcbb[cpc]; }
+    inline BB BbPieces(CPT cpt) const noexcept { return mpcptbb[cpt]; }
+    inline BB BbPieces(CPC cpc, CPT cpt) const noexcept { return mpcpcbb[cpc] & mpcptbb[cpt]; }
+
     /* make and undo move */
     void MakeMv(const MV& mv) noexcept;
     void MakeMvNull(void) noexcept;
@@ -662,11 +1017,18 @@ public:
     void MoveGen(VMV& vmv) const noexcept;
     void MoveGenPseudo(VMV& vmv) const noexcept;
     void MoveGenNoisy(VMV& vmv) const noexcept;
+    void MoveGenLegal(GEN gen, VMV& vmv) const noexcept;
+    void MoveGenEvasions(VMV& vmv) const noexcept;
+    void MoveGenQuietChecks(VMV& vmv) const noexcept;
     bool FMvWasLegal(void) const noexcept;
+    bool FMvIsLegal(const MV& mv) const noexcept;
 
     /* attack squares and checks */
     bool FInCheck(CPC cpc) const noexcept;
     bool FIsAttackedBy(int8_t icpAttacked, CPC cpcBy) const noexcept;
+    BB BbAttackersTo(SQ sq, CPC cpcBy, BB bbOccupied) const noexcept;
+    BB BbPinned(CPC cpc) const noexcept;
+    bool SeeGe(const MV& mv, EV evThreshold) const noexcept;
     CPT CptSqAttackedBy(SQ sq, CPC cpcBy) const noexcept;
     bool FMvIsCapture(const MV& mv) const noexcept;
     bool FMvIsNoisy(const MV& mv) const noexcept;
@@ -674,13 +1036,14 @@ public:
 
     /* bitboards */
     BB BbPawns(CPC cpc) const noexcept;
-    BB BbAttacked(CPC cpc) noexcept;
+    BB BbAttacked(CPC cpc) const noexcept;
     BB BbAttackedFromVmv(const VMV& vmv) const noexcept;
 
     /* game phase and status */
     int PhaseCur(void) const noexcept;
     bool FGameDrawn(int cbd) const noexcept;
     bool FDrawRepeat(int cbdDraw) const noexcept;
+    bool FUpcomingRepeat(int d) const noexcept;
     bool FDrawDead(void) const noexcept;
     bool FSufficientMaterial(CPC cpc) const noexcept;
 
@@ -705,22 +1068,33 @@ public:
     EV EvMaterial(CPC cpc) const noexcept;
 
 private:
-    void RemoveChecks(VMV& vmv) const noexcept;
-
-    void MoveGenPawn(int8_t icpFrom, VMV& vmv) const noexcept;
-    void MoveGenPawnNoisy(int8_t icpFrom, VMV& vmv) const noexcept;
-    void MoveGenKing(int8_t icpFrom, VMV& vmv) const noexcept;
-    void MoveGenKingNoisy(int8_t icpFrom, VMV& vmv) const noexcept;
-    void MoveGenSingle(int8_t icpFrom, const int8_t adicp[], int8_t cdicp, VMV& vmv) const noexcept;
-    void MoveGenSingleNoisy(int8_t icpFrom, const int8_t adicp[], int8_t cdicp, VMV& vmv) const noexcept;
-    void MoveGenSlider(int8_t icpFrom, const int8_t adicp[], int8_t cdicp, VMV& vmv) const noexcept;
-    void MoveGenSliderNoisy(int8_t icpFrom, const int8_t adicp[], int8_t cdicp, VMV& vmv) const noexcept;
-    void AddPawnMoves(int8_t icpFrom, int8_t icpTo, VMV& vmv) const noexcept;
-    void AddCastle(int8_t icpKingFrom, int8_t fiKingTo, int8_t fiRookFrom, int8_t fiRookTo, CS csMove, VMV& vmv) const noexcept;
-
-    bool FIsAttackedBySingle(int8_t icpAttacked, CP cp, const int8_t adicp[], int8_t cdicp) const noexcept;
-    bool FIsAttackedBySlider(int8_t icpAttacked, uint16_t grfCp, const int8_t adicp[], int8_t cdicp) const noexcept;
-    int8_t IcpbdFindKing(CPC cpcKing) const noexcept;
+    /* the make, undo, and move generation workers are specialized on the
+       side to move, and the public versions dispatch on cpcToMove */
+    template <CPC cpcMove> void MakeMv(const MV& mv) noexcept;
+    template <CPC cpcMove> void UndoMv(void) noexcept;
+
+    template <CPC cpcMove> void MoveGenPseudo(VMV& vmv) const noexcept;
+    template <CPC cpcMove> void MoveGenLegal(GEN gen, VMV& vmv) const noexcept;
+    template <CPC cpcMove> void MoveGenEvasions(VMV& vmv) const noexcept;
+    template <CPC cpcMove> void MoveGenQuietChecks(VMV& vmv) const noexcept;
+    template <CPC cpcMove> void MoveGenKingLegal(SQ sqKing, BB bbTarget, VMV& vmv) const noexcept;
+    template <CPC cpcMove> void MoveGenPiecesLegal(GEN gen, SQ sqKing, BB bbTarget, VMV& vmv) const noexcept;
+    template <CPC cpcMove> void MoveGenPawnsLegal(GEN gen, SQ sqKing, BB bbTarget, BB bbPinned, VMV& vmv) const noexcept;
+    bool FEnPassantLegal(SQ sqFrom, SQ sqKing) const noexcept;
+    BB BbBlockers(SQ sqKing, CPC cpcSniper) const noexcept;
+    template <CPC cpcMove> void AddPawnMoves(SQ sqFrom, SQ sqTo, VMV& vmv) const noexcept;
+
+    template <CPC cpcMove> void MoveGenPawn(int8_t icpFrom, VMV& vmv) const noexcept;
+    template <CPC cpcMove> void MoveGenPawnNoisy(int8_t icpFrom, VMV& vmv) const noexcept;
+    template <CPC cpcMove> void MoveGenKing(int8_t icpFrom, VMV& vmv) const noexcept;
+    void AddMoves(SQ sqFrom, BB bbTo, VMV& vmv) const noexcept;
+    template <CPC cpcMove> void AddPawnMoves(int8_t icpFrom, int8_t icpTo, VMV& vmv) const noexcept;
+    template <CPC cpcMove> void AddCastle(int8_t icpKingFrom, int8_t fiKingTo, int8_t fiRookFrom, int8_t fiRookTo, CS csMove, VMV& vmv) const noexcept;
+
+    inline int8_t IcpbdFindKing(CPC cpcKing) const noexcept
+    {
+        return IcpbdFromSq(mpcpcsqKing[cpcKing]);
+    }
     int8_t IcpUnused(CPC cpc, CPT cptHint) const noexcept;
     inline void ClearCs(CS cs, CPC cpc) noexcept
     {
@@ -729,16 +1103,53 @@ private:
         csCur &= ~cs;
     }
 
+    /* keep the bitboards and the running evaluation totals in sync with 
+       pieces coming and going on the mailbox */
+    inline void AddPiece(SQ sq, CP cp) noexcept
+    {
+        mpcpcbb[cpc(cp)] |= sq;
+        mpcptbb[cpt(cp)] |= sq;
+        mpcpcevp[cpc(cp)] += mpcpsqevp[cp][sq];
+        mpcpcevMaterial[cpc(cp)] += mpcptevMaterial[cpt(cp)];
+        mk += MkFromCp(cp);
+        phase -= mpcptphase[cpt(cp)];
+    }
+    inline void RemovePiece(SQ sq, CP cp) noexcept
+    {
+        mpcpcbb[cpc(cp)] -= sq;
+        mpcptbb[cpt(cp)] -= sq;
+        mpcpcevp[cpc(cp)] -= mpcpsqevp[cp][sq];
+        mpcpcevMaterial[cpc(cp)] -= mpcptevMaterial[cpt(cp)];
+        mk -= MkFromCp(cp);
+        phase += mpcptphase[cpt(cp)];
+    }
+    inline void MovePiece(SQ sqFrom, SQ sqTo, CP cp) noexcept
+    {
+        BB bb = BB(sqFrom) | sqTo;
+        mpcpcbb[cpc(cp)] ^= bb;
+        mpcptbb[cpt(cp)] ^= bb;
+        mpcpcevp[cpc(cp)] += mpcpsqevp[cp][sqTo] - mpcpsqevp[cp][sqFrom];
+    }
+
 public:
     CPBD acpbd[(raMax+4)*(fiMax+2)];  // 8x8 plus 4 guard ranks and 2 guard files
     static constexpr uint8_t icpMax = 16;
     int8_t aicpbd[cpcMax][icpMax];  // cpc x piece index -> offset into acpbd array
+    BB mpcpcbb[cpcMax];     // occupied squares of each color
+    BB mpcptbb[cptMax];     // occupied squares of each piece type, both colors
+    SQ mpcpcsqKing[cpcMax]; // where the kings are
     CPC cpcToMove = cpcWhite;
     CS csCur = csNone;
     SQ sqEnPassant = sqNil;
     uint8_t cmvNoCaptureOrPawn = 0; // number of moves since last capture or pawn move
     HA ha = 0;  // zobrist hash of the board
-    vector<MVU> vmvuGame;
+
+    /* running evaluation totals, kept up to date as pieces move */
+    EVP mpcpcevp[cpcMax];   // piece square table total
+    EV mpcpcevMaterial[cpcMax]; // simple material count
+    MK mk = 0;              // material key, the number of each piece on the board
+    int phase = phaseMax;   // game phase, decreases as pieces come off the board
+    VMVU vmvuGame;
 
 public:
 #ifndef NDEBUG
@@ -750,15 +1161,14 @@ public:
 #endif
 };
 
-extern const int mpcptphase[cptMax];
-
 /**
  *  Move undo constructor
  */
 
-MVU::MVU(MV mv, const BD& bd) :
-    MV(mv),
+MVU::MVU(const MV& mv, const BD& bd) :
+    MVC(mv),
     cpTake(cpEmpty),
+    icpTake(0),
     csSav(bd.csCur),
     sqEnPassantSav(bd.sqEnPassant),
     cmvNoCaptureOrPawnSav(bd.cmvNoCaptureOrPawn),
@@ -12,9 +12,66 @@
  *  @copyright  Copyright (c) 2025 by Richard Powell
  */
 
+#ifdef CONSOLE
+
+/*
+ *  The headless console build only has the chess engine: the board, move
+ *  generation, the search, and the file format readers and writers. None 
+ *  of the UI classes are available.
+ */
+
+#include "util.h"
+#include "err.h"
+#include "game.h"
+
+/**
+ *  @class LOGCON
+ *  @brief The console logging stream
+ * 
+ *  The headless stand-in for the WNLOG logging window. It supports the same
+ *  indent and outdent stream modifiers and the same log level filtering.
+ *  Logged lines are forwarded to an optional output stream, and are thrown 
+ *  away if there isn't one.
+ */
+
+class LOGCON;
+
+class logconbuf : public streambuf
+{
+public:
+    logconbuf(LOGCON& logcon);
+    virtual int_type overflow(int_type ch = traits_type::eof()) override;
+
+private:
+    LOGCON& logcon;
+    string buffer;
+};
+
+class LOGCON : public ostream
+{
+public:
+    LOGCON(void);
+    void SetOutput(ostream* posNew);
+    void ReceiveStream(int level, const string& s);
+    inline int get_level(void) { return indentation::get_level(*this); }
+    inline bool FUnderLevel(void) { return posOut != nullptr && levelLog >= get_level(); }
+
+    int levelLog = 1;
+
+private:
+    logconbuf sb;
+    ostream* posOut = nullptr;
+};
+
+extern LOGCON logcon;
+extern bool fValidate;
+
+#else
+
 #include "wapp.h"
 #include "game.h"
 class CMDMAKEMOVE;
+class PERFT;
 
 /**
  *  @class WNPC
@@ -238,7 +295,7 @@ public:
     void RunPerft(void);
     bool FRunHash(BD& bd, int d);
     void RunPerftSuite(void);
-    bool RunOnePerftTest(const char tag[], const char fen[], const int64_t mpdcmv[],  
+    bool RunOnePerftTest(PERFT& perft, const char tag[], const char fen[], const int64_t mpdcmv[],  
                          microseconds& dtpTotal, int64_t& cmvTotal);
     void RunPolyglotTest(void);
     void RunAITest(filesystem::path folder, const vector<filesystem::path>& vfile);
@@ -343,4 +400,6 @@ CMD_DECLARE(CMDREQUESTMOVE)
 public:
     CMDREQUESTMOVE(WAPP& wapp) : CMD(wapp) {}
     virtual int Execute(void) override;
-};
\ No newline at end of file
+};
+
+#endif // CONSOLE
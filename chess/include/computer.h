@@ -49,7 +49,7 @@ public:
         int dev = evBeta - evAlpha;
         if (evAlpha > -evMateMin)
             evAlpha += dev / 2;
-        evBeta = dev > 200 ? evInfinity : min(evBeta + dev, evInfinity);
+        evBeta = dev > 200 ? evInfinity : min(evBeta + dev, (int)evInfinity);
         assert(evAlpha <= evBeta);
     }
 
@@ -89,7 +89,7 @@ public:
 
 constexpr AB AbAspiration(EV ev, EV dev) noexcept
 {
-    return AB(max(ev - dev, -evInfinity), min(ev + dev, evInfinity));
+    return AB(max(ev - dev, -evInfinity), min(ev + dev, (int)evInfinity));
 }
 
 constexpr AB AbInfinite(void) noexcept
@@ -147,17 +147,19 @@ public:
 
     MV Mv(void) const noexcept
     {
-        return MV((SQ)sqFrom, (SQ)sqTo, (CPT)cptPromote, (CS)csMove);
+        return MV(mvc);
+    }
+
+    MVC Mvc(void) const noexcept
+    {
+        return mvc;
     }
 
 public:
     uint32_t haTop;          // high 32 bits of hash
-    uint32_t dd : 7,
-             tev : 2,
-             sqFrom : 6,
-             sqTo : 6,
-             csMove : 4,
-             cptPromote : 3;
+    uint16_t dd : 7,
+             tev : 2;
+    MVC mvc;                 // best move
     EV evBiased;          // evaluation
 };
 
@@ -183,6 +185,52 @@ private:
     XTEV* axtev = nullptr;
 };
 
+/**
+ *  @class      PV
+ *  @brief      A principal variation
+ * 
+ *  @details    The line of best play the search found from some ply. Each 
+ *              ply keeps its own, and copies its child's up behind the move
+ *              whenever a move raises alpha, which gives us the classic 
+ *              triangular PV table without depending on the transposition 
+ *              table holding onto the line.
+ */
+
+class PV
+{
+public:
+    void clear(void) noexcept { cmv = 0; }
+    int size(void) const noexcept { return cmv; }
+    MVC operator [] (int imv) const noexcept { return amvc[imv]; }
+
+    void Set(const MV& mv, const PV& pvRest) noexcept
+    {
+        amvc[0] = MVC(mv);
+        cmv = min(pvRest.cmv + 1, dMax);
+        for (int imv = 1; imv < cmv; imv++)
+            amvc[imv] = pvRest.amvc[imv - 1];
+    }
+
+    void Set(const MV& mv) noexcept
+    {
+        amvc[0] = MVC(mv);
+        cmv = 1;
+    }
+
+private:
+    MVC amvc[dMax];
+    int cmv = 0;
+};
+
+/**
+ *  History tables for quiet moves, indexed by the piece and the square it 
+ *  moves to. Continuation history has one of these for every piece and 
+ *  square of an earlier move.
+ */
+
+using HT = array<array<int16_t, sqMax>, cpMax>;
+using MPCPSQHT = array<array<HT, sqMax>, cpMax>;
+
 /**
  *  @class      HD
  *  @brief      Search history data at each depth
@@ -198,6 +246,14 @@ public:
     uint8_t cmvQuiet = 0;
     bool fImproving = false;
     bool fInCheck = false;
+    bool fFollowPv = false;     // we got here along the previous iteration's PV
+    MVC mvcPv;                  // the previous iteration's PV move, if we're following it
+    MVC mvcExclude;             // move to skip in a singular extension search
+    CP cpPrev = cpEmpty;        // piece and square of the move that got us here
+    SQ sqPrev = sqNil;
+    HT* phtCont1 = nullptr;     // continuation history after the previous move
+    HT* phtCont2 = nullptr;     // continuation history after our move before that
+    PV pv;                      // best line from here
 };
 
 /**
@@ -213,7 +269,9 @@ struct SETAI
         fRazoring : 1 = true,
         fFutilityPruning : 1 = true,
         fLateMovePruning : 1 = true,
-        fLateMoveReduction : 1 = false,
+        fLateMoveReduction : 1 = true,
+        fInternalIterativeReduction : 1 = false,
+        fSingularExtension : 1 = true,
         fHistory : 1 = true,
         fKillers : 1 = true,
         fPSQT : 1 = true,
@@ -223,7 +281,8 @@ struct SETAI
         fPawnStructure : 1 = true,
         fTempo : 1 = false,
         fPV : 1 = true,
-        fAspiration : 1 = true;
+        fAspiration : 1 = true,
+        fQuiescentChecks : 1 = true;
 
     int cmbXt = 64;     // megabytes in transposition table
     int dMax = 100;
@@ -239,6 +298,8 @@ struct SETAI
             << "\"futility\": " << to_string_bool(fFutilityPruning) << ','
             << "\"latemovepruning\": " << to_string_bool(fLateMovePruning) << ','
             << "\"latemovereduction\": " << to_string_bool(fLateMoveReduction) << ','  
+            << "\"internaliterativereduction\": " << to_string_bool(fInternalIterativeReduction) << ','
+            << "\"singularextension\": " << to_string_bool(fSingularExtension) << ','
             
             << "\"history\": " << to_string_bool(fHistory) << ',' 
             << "\"killers\": " << to_string_bool(fKillers) << ','
@@ -252,6 +313,7 @@ struct SETAI
             
             << "\"pv\": " << (fPV) << ','
             << "\"aspiration\": " << (fAspiration) << ','
+            << "\"quiescentchecks\": " << (fQuiescentChecks) << ','
 
             << "\"xtsize\": " << cmbXt
             << "}";
@@ -280,8 +342,15 @@ struct STATAI {
     int64_t cmvRazoring = 0;
     int64_t cmvFutilityPruning = 0;
     int64_t cmvLateMovePruning = 0;
+    int64_t cmvLateMoveReduction = 0;
+    int64_t cmvInternalIterativeReduction = 0;
+    int64_t cmvSingularExtension = 0;
+    int64_t cmvMultiCut = 0;
+    int64_t cmvSeePruning = 0;
     int64_t cmvLeaf = 0;
     int64_t cmvMoveGen = 0;
+    int64_t cmvCut = 0;         // beta cut-offs in the main search
+    int64_t cmvCutFirst = 0;    // the ones that happened on the first move
 
     milliseconds ms = 0ms;
 
@@ -296,8 +365,15 @@ struct STATAI {
         cmvRazoring += stat.cmvRazoring;
         cmvFutilityPruning += stat.cmvFutilityPruning;
         cmvLateMovePruning += stat.cmvLateMovePruning;
+        cmvLateMoveReduction += stat.cmvLateMoveReduction;
+        cmvInternalIterativeReduction += stat.cmvInternalIterativeReduction;
+        cmvSingularExtension += stat.cmvSingularExtension;
+        cmvMultiCut += stat.cmvMultiCut;
+        cmvSeePruning += stat.cmvSeePruning;
         cmvLeaf += stat.cmvLeaf;
         cmvMoveGen += stat.cmvMoveGen;
+        cmvCut += stat.cmvCut;
+        cmvCutFirst += stat.cmvCutFirst;
         ms += stat.ms;
         return *this;
     }
@@ -335,14 +411,20 @@ class AI
 public:
     AI(const SETAI& setai);
 
+#ifndef CONSOLE
     MV MvBestTest(WAPP& wapp, GAME& game, const TMAN& tman);
+#endif
 
     /* basic alpha-beta search */
     MV MvBest(BD& bd, const TMAN& tman) noexcept;
     EV EvSearchPv(BD& bd, AB ab, int d, int dLim, HD mpdhd[], SO so) noexcept;
     //EV EvSearchZw(BD& bd, AB ab, int d, int dLim, HD mpdhd[], SO so) noexcept;
-    EV EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[]) noexcept;
-    bool FDeepen(BD& bd, MV& mvBestAll, MV mvBest, AB& ab, int& d) noexcept;
+    EV EvQuiescent(BD& bd, AB ab, int d, HD mpdhd[], bool fChecks) noexcept;
+    bool FDeepen(BD& bd, MV& mvBestAll, MV mvBest, const PV& pv, AB& ab, int& d) noexcept;
+    virtual void ReportDepth(BD& bd, int d, const MV& mvBest) noexcept {}
+    PV pvBestAll;   // principal variation of the last completed depth
+    int dLimRoot = 0;   // depth of the current iteration
+    bool FExtend(int d) const noexcept { return d < 2 * dLimRoot; }
     bool FPrune(AB& ab, MV& mv, int& dLim) noexcept;
     bool FPrune(AB& ab, MV& mv, MV& mvBest, int& dLim) noexcept;
     bool FPrune(AB& ab, MV& mv) noexcept;
@@ -360,31 +442,31 @@ public:
     TP tpSearchStart;
     TP tpSearchEnd;
     int dSearchMax = 100;
+    uint64_t cmvSearchMax = UINT64_MAX;
     enum class TINT {   /** type of interruption */
         Thinking = 0,
         MoveAndPause,
         MoveAndContinue,
         Halt
     } tint;
-    bool fInterruptSearch = false;
+    atomic<bool> fInterruptSearch = false;  // halt the search, no move is made
+    atomic<bool> fStopSearch = false;       // stop the search and play the best move so far
 
     /* static board evaluation */
     virtual EV EvStatic(BD& bd) noexcept;
     EV EvMaterial(BD& bd) const noexcept;
     EV EvMobility(BD& bd) const noexcept;
     /* piece square tables */
-    EV EvFromPsqt(const BD& bd) const noexcept;
-    EV EvPieceCombos(int accp[], CPC cpc) const noexcept;
-    EV EvPair(int accp[], CPC cpc, CPT cpt, EV evPair) const noexcept;
-    void InitPsts(void) noexcept;
-    EV mpcpsqevMid[cpMax][sqMax];
-    EV mpcpsqevEnd[cpMax][sqMax];
+    EV EvTaper(const BD& bd, EVP evp) const noexcept;
+    EVP EvpFromPsqt(const BD& bd) const noexcept;
+    EVP EvpPieceCombos(MK mk, CPC cpc) const noexcept;
+    EVP EvpPair(MK mk, CPC cpc, CPT cpt, EVP evpPair) const noexcept;
     /* king safety */
-    EV EvKingSafety(BD& bd) const noexcept;
-    EV EvKingSafety(BD& bd, CPC cpc) const noexcept;
+    EVP EvpKingSafety(BD& bd) const noexcept;
+    EVP EvpKingSafety(BD& bd, CPC cpc) const noexcept;
     /* pawn structure */
-    EV EvPawnStructure(BD& bd) const noexcept;
-    EV EvPawnStructure(BB bbPawns, BB bbDefense, CPC cpc) const noexcept;
+    EVP EvpPawnStructure(BD& bd) const noexcept;
+    EVP EvpPawnStructure(BB bbPawns, BB bbDefense, CPC cpc) const noexcept;
     int CfiDoubledPawns(BB bbPawns, CPC cpc) const noexcept;
     int CfiIsoPawns(BB bbPawns, CPC cpc) const noexcept;
     int CfiPassedPawns(BB bb, BB bbDefense, CPC cpc) const noexcept;
@@ -401,15 +483,16 @@ public:
     bool FTryFutility(BD& bd, AB ab, int d, int dLim, HD mpdhd[]) noexcept;
     bool FMvWasFutile(BD& bd, const MV& mv) noexcept;
     bool FMvLateMovePruning(BD& bd, const MV& mv, int d, int dLim, HD mpdhd[]) noexcept;
-    bool FMvLateMoveReduction(BD& bd, const MV& mv, int& ddReduction) noexcept;
+    bool FMvLateMoveReduction(BD& bd, MV& mv, AB ab, int d, int dLim, HD mpdhd[], int cmvLegal, SO so) noexcept;
+    bool FTryInternalIterativeReduction(BD& bd, AB ab, MVC mvcPv, int d, int& dLim) noexcept;
+    bool FTrySingularExtension(BD& bd, AB ab, int d, int dLim, HD mpdhd[], SO so, MVC& mvcSingular, EV& ev) noexcept;
     bool FZugzwangPossible(BD& bd) noexcept;
 
 
     /* move scoring for sorting move lists */
     void ScoreCapture(BD& bd, MV& mv) noexcept;
-    bool FScoreMove(BD& bd, MV& mv) noexcept;
+    bool FScoreMove(const BD& bd, MV& mv, BB bbThreat) noexcept;
     bool FScoreXt(BD& bd, MV& mv) noexcept;
-    EV EvAttackDefend(BD& bd, const MV& mvPrev) const noexcept;
 
     /* track killer moves */
     void InitKillers() noexcept;
@@ -417,16 +500,23 @@ public:
     bool FScoreKiller(BD& bd, MV& mv) noexcept;
     static const int cmvKillersGameMax = 256;
     static const int cmvKillersMoveMax = 4;
-    MV amvKillers[cmvKillersGameMax][cmvKillersMoveMax] = { {0} };
+    MVC amvcKillers[cmvKillersGameMax][cmvKillersMoveMax];
 
     /* track history moves */
     void InitHistory() noexcept;
     void AddHistory(BD& bd, const MV& mv, int d, int dLim) noexcept;
     void SubtractHistory(BD& bd, const MV& mv) noexcept;
     void AgeHistory(void) noexcept;
-    bool FScoreHistory(BD& bd, MV& mv) noexcept;
+    bool FScoreHistory(BD& bd, MV& mv, const HD* phd) noexcept;
     int mpcpsqcHistory[cpMax][sqMax] = { {0} };
 
+    /* counter moves and continuation history */
+    void InitContinuation(BD& bd, HD mpdhd[], int d) noexcept;
+    void AddContinuation(BD& bd, const HD& hd, const MV& mv, const MVC amvcTried[], int cmvTried, int dd) noexcept;
+    MVC mpcpsqmvcCounter[cpMax][sqMax];
+    unique_ptr<MPCPSQHT> pmpcpsqhtCont1;
+    unique_ptr<MPCPSQHT> pmpcpsqhtCont2;
+
     /* stats */
     void InitStats(void) noexcept;
     void LogStats(TP tpEnd) noexcept;
@@ -439,6 +529,8 @@ public:
 
 extern SETAI setaiDefault;
 
+#ifndef CONSOLE
+
 /**
  *  @class      PLAI
  *  @brief      A computer AI player
@@ -458,3 +550,5 @@ public:
     virtual void RequestMv(WAPP& wapp, GAME& game, const TMAN& tman) override;
     virtual void Interrupt(WAPP& wapp, GAME& game) override;
 };
+
+#endif // CONSOLE
@@ -317,6 +317,7 @@ private:
     CHK chkFutilityPruning;
     CHK chkLateMovePruning;
     CHK chkLateMoveReduction;
+    CHK chkInternalIterativeReduction;
 
     GROUP groupMoveOrder;
     CHK chkKillers;
@@ -333,6 +334,8 @@ private:
     GROUP groupOther;
     CHK chkPV;
     CHK chkAspiration;
+    CHK chkQuiescentChecks;
+    CHK chkSingularExtension;
     EDIT editXt;
     EDIT editDepthMax;
 
@@ -0,0 +1,104 @@
+#pragma once
+
+/**
+ *  @file       perft.h
+ *  @brief      Fast perft engine and the perft test suite
+ *
+ *  @details    The plain perft in the test code makes and unmakes every move
+ *              to the leaves, which is what we want for testing MakeMv and
+ *              UndoMv, but it's too slow to verify the move generator at the
+ *              deeper depths. This one keeps a transposition table of node
+ *              counts, counts legal moves in bulk at the last ply, and splits
+ *              the root moves across threads.
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "board.h"
+#include <mutex>
+#include <condition_variable>
+
+/**
+ *  @class      XPERFT
+ *  @brief      Perft transposition table entry
+ *
+ *  @details    The move count and depth are packed into one word, and the
+ *              hash is saved xor'ed with that word. Threads share the table
+ *              without locking; an entry torn by two threads writing at once
+ *              just fails to match and is treated as a miss.
+ */
+
+class XPERFT
+{
+    friend class PERFT;
+
+    atomic<uint64_t> haXor = 0;
+    atomic<uint64_t> grf = 0;    // move count in the high 56 bits, depth in the low 8
+};
+
+/**
+ *  @class      PERFT
+ *  @brief      Hashed, multithreaded perft
+ *
+ *  @details    The worker threads are started once when the engine is 
+ *              created and sleep between calls, so a suite run doesn't pay
+ *              for starting and joining threads on every position and depth.
+ */
+
+class PERFT
+{
+public:
+    PERFT(uint32_t cmbHash = 64, int cthread = 0);
+    ~PERFT();
+
+    void Clear(void) noexcept;
+    int64_t CmvPerft(const BD& bd, int d);
+    int Cthread(void) const noexcept { return cthread; }
+
+private:
+    int64_t CmvPerftHash(BD& bd, int d) noexcept;
+    XPERFT& operator [] (HA ha) noexcept { return axperft[ha & (cxperft - 1)]; }
+    void WorkerLoop(void);
+    void Work(void);
+
+    unique_ptr<XPERFT[]> axperft;
+    uint64_t cxperft = 0;
+    int cthread;
+
+    /* the thread pool and the job it's working on */
+    vector<thread> vthread;
+    mutex mtx;
+    condition_variable cvStart;
+    condition_variable cvDone;
+    uint64_t ijob = 0;
+    int cthreadBusy = 0;
+    bool fQuit = false;
+    const BD* pbdJob = nullptr;
+    const VMV* pvmvJob = nullptr;
+    int dJob = 0;
+    atomic<int> imvNext = 0;
+    atomic<int64_t> cmvJob = 0;
+};
+
+/**
+ *  @struct     PERFTTEST
+ *  @brief      A perft test position with the move counts we expect
+ *
+ *  @details    mpdcmv is indexed by depth and ends with a 0 entry. Depths we
+ *              don't have a count for are -1.
+ */
+
+struct PERFTTEST
+{
+    const char* sTitle;
+    const char* fen;
+    int64_t mpdcmv[20];
+};
+
+extern const PERFTTEST aperft[];
+extern const int cperft;
+
+/* how deep the suite runs by default; the deeper counts on the 
+   chessprogramming.org positions run into the trillions of nodes */
+constexpr int dPerftSuiteMax = 7;
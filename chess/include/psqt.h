@@ -12,17 +12,16 @@
 
 /*  middle game */
 
-extern EV mpcptevMid[cptMax];
-extern EV mpcptsqdevMid[cptMax][sqMax]; 
+extern const EV mpcptevMid[cptMax];
+extern const EV mpcptsqdevMid[cptMax][sqMax]; 
 
 /* end game */
 
-extern EV mpcptevEnd[cptMax];
-extern EV mpcptsqdevEnd[cptMax][sqMax];
+extern const EV mpcptevEnd[cptMax];
+extern const EV mpcptsqdevEnd[cptMax][sqMax];
 
 /*  
- *  Build and interpolate inside the tables 
+ *  Interpolate inside the tables 
  */
 
-void InitPsqt(EV mpcptev[cptMax], EV mpcptsqdev[cptMax][sqMax], EV mpcpsqev[cpMax][sqMax]) noexcept;
 EV EvInterpolate(int phaseCur, EV evFirst, int phaseFirst, EV evLim, int phaseLim) noexcept;
@@ -114,6 +114,7 @@
 #define rssAISettingsFutilityPruning 1106
 #define rssAISettingsLateMovePruning 1107
 #define rssAISettingsLateMoveReduction 1108
+#define rssAISettingsInternalIterativeReduction 1109
 #define rssAISettingsMoveOrderGroup 1110
 #define rssAISettingsKillers 1111
 #define rssAISettingsHistory 1112
@@ -129,6 +130,8 @@
 #define rssAISettingsPV 1141
 #define rssAISettingsXtSize 1142
 #define rssAISettingsDepthMax 1143
+#define rssAISettingsQuiescentChecks 1144
+#define rssAISettingsSingularExtension 1145
 
 #define rssGameSettingsTitle 1200
 #define rssGameSettingsInstructions 1201
@@ -142,6 +145,7 @@
 #define rssPerftDivide 1403
 #define rssPerftBulk 1404
 #define rssPerftHash 1405
+#define rssPerftFast 1406
 
 /*
  *  PNGs
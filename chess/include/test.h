@@ -43,7 +43,8 @@ enum class TPERFT {
     Perft,
     Divide,
     Bulk,
-    Hash
+    Hash,
+    Fast
 };
 
 /**
@@ -137,6 +138,7 @@ private:
     SELPERFT selDivide;
     SELPERFT selBulk;
     SELPERFT selHash;
+    SELPERFT selFast;
 };
 
 /**
@@ -11,31 +11,26 @@
 
 #include "board.h"
 
-/*
- *  Piece direction offsets in the raw board array
- */
-
-static const int8_t adicpbdBishop[] = { -11, -9, 9, 11 };
-static const int8_t adicpbdRook[] = { -10, -1, 1, 10 };
-static const int8_t adicpbdQueen[] = { -11, -10, -9, -1, 1, 9, 10, 11 };
-static const int8_t adicpbdKnight[] = { -21, -19, -12, -8, 8, 12, 19, 21 };
-static const int8_t adicpbdKing[] = { -11, -10, -9, -1, 1, 9, 10, 11 };
-static const int8_t adicpbdPawn[] = { 9, 11, -11, -9 };  /* first 2 are white, second 2 are black */
-
 /**
  *  @fn         void BD::MoveGen(VMV& vmv) const
  *  @brief      Generates all legal moves
  * 
  *  @details    We have two basic move generators, one that really returns all 
  *              legal moves, and another that is a pseudo-legal move generator.
- *              The check test is expensive, so we only use this variant in
- *              code that is not as speed critical.
+ *              The legal generator works out checks and pins once for the 
+ *              whole position, so it only costs a little more than the 
+ *              pseudo-legal one, and the search never has to test moves for
+ *              legality after making them.
  */
 
 void BD::MoveGen(VMV& vmv) const noexcept
 {
-    MoveGenPseudo(vmv);
-    RemoveChecks(vmv);
+    if (FInCheck(cpcToMove))
+        MoveGenEvasions(vmv);
+    else {
+        vmv.clear();
+        MoveGenLegal(GEN::All, vmv);
+    }
 }
 
 /**
@@ -48,6 +43,15 @@ void BD::MoveGen(VMV& vmv) const noexcept
  *              check test on moves that get pruned.
  */
 
+void BD::MoveGenPseudo(VMV& vmv) const noexcept
+{
+    if (cpcToMove == cpcWhite)
+        MoveGenPseudo<cpcWhite>(vmv);
+    else
+        MoveGenPseudo<cpcBlack>(vmv);
+}
+
+template <CPC cpcMove>
 void BD::MoveGenPseudo(VMV& vmv) const noexcept
 {
     Validate();
@@ -55,28 +59,32 @@ void BD::MoveGenPseudo(VMV& vmv) const noexcept
     vmv.clear();
     vmv.reserve(VMV::cmvGenMax);
 
+    BB bbOccupied = BbOccupied();
+    BB bbTo = ~BbColor(cpcMove);
+
     for (int icp = 0; icp < icpMax; icp++) {
-        int icpbdFrom = aicpbd[cpcToMove][icp];
+        int icpbdFrom = aicpbd[cpcMove][icp];
         if (icpbdFrom == -1)
             continue;
+        SQ sqFrom = SqFromIcpbd(icpbdFrom);
         switch (acpbd[icpbdFrom].cpt) {
         case cptPawn:
-            MoveGenPawn(icpbdFrom, vmv);
+            MoveGenPawn<cpcMove>(icpbdFrom, vmv);
             break;
         case cptKnight:
-            MoveGenSingle(icpbdFrom, adicpbdKnight, size(adicpbdKnight), vmv);
+            AddMoves(sqFrom, mpbb.BbKnightTo(sqFrom) & bbTo, vmv);
             break;
         case cptBishop:
-            MoveGenSlider(icpbdFrom, adicpbdBishop, size(adicpbdBishop), vmv);
+            AddMoves(sqFrom, mpbb.BbBishopAttacks(sqFrom, bbOccupied) & bbTo, vmv);
             break;
         case cptRook:
-            MoveGenSlider(icpbdFrom, adicpbdRook, size(adicpbdRook), vmv);
+            AddMoves(sqFrom, mpbb.BbRookAttacks(sqFrom, bbOccupied) & bbTo, vmv);
             break;
-        case cptQueen: /* a queen is a sliding king */
-            MoveGenSlider(icpbdFrom, adicpbdKing, size(adicpbdKing), vmv);
+        case cptQueen:
+            AddMoves(sqFrom, mpbb.BbQueenAttacks(sqFrom, bbOccupied) & bbTo, vmv);
             break;
         case cptKing:
-            MoveGenKing(icpbdFrom, vmv);
+            MoveGenKing<cpcMove>(icpbdFrom, vmv);
             break;
         default:
             assert(false);
@@ -87,69 +95,465 @@ void BD::MoveGenPseudo(VMV& vmv) const noexcept
 
 /**
  *  @fn         void BD::MoveGenNoisy(VMV& vmv) const
- *  @brief      Generates all noisy moves
+ *  @brief      Generates all legal noisy moves
  * 
- *  @details    Noisy moves are captures and pawn promotions. This is used in
- *              quiescence search to extend the search on captures.
+ *  @details    Noisy moves are captures, including en passant and capture
+ *              promotions. This is used in quiescence search to extend the 
+ *              search on captures.
  */
 
 void BD::MoveGenNoisy(VMV& vmv) const noexcept
+{
+    vmv.clear();
+    MoveGenLegal(GEN::Noisy, vmv);
+}
+
+/**
+ *  @fn         void BD::MoveGenLegal(GEN gen, VMV& vmv) const
+ *  @brief      The legal move generator
+ * 
+ *  @details    Adds the legal moves of the given type to the end of the move
+ *              list. The staged move picker calls this once for the noisy
+ *              moves and again for the quiet moves, only if it needs them.
+ *
+ *              Finds the pieces giving check and the pieces pinned against
+ *              our king, and uses them to build destination masks for every 
+ *              piece, so every move we emit is legal.
+ * 
+ *              In double check, only the king can move. In single check, the
+ *              other pieces must capture the checker or block it. Pinned 
+ *              pieces can only move along the line through the king and the 
+ *              pinner, which leaves pinned knights with no moves at all. King
+ *              moves are tested against the attack map with the king removed,
+ *              so the king can't step backwards along the line of a slider
+ *              that's checking it.
+ */
+
+void BD::MoveGenLegal(GEN gen, VMV& vmv) const noexcept
+{
+    if (cpcToMove == cpcWhite)
+        MoveGenLegal<cpcWhite>(gen, vmv);
+    else
+        MoveGenLegal<cpcBlack>(gen, vmv);
+}
+
+template <CPC cpcMove>
+void BD::MoveGenLegal(GEN gen, VMV& vmv) const noexcept
 {
     Validate();
 
+    SQ sqKing = SqKing(cpcMove);
+    BB bbOccupied = BbOccupied();
+    BB bbTarget;
+    switch (gen) {
+    case GEN::All: 
+        bbTarget = ~BbColor(cpcMove); 
+        break;
+    case GEN::Noisy: 
+        bbTarget = BbColor(~cpcMove); 
+        break;
+    case GEN::Quiet: 
+        bbTarget = ~bbOccupied; 
+        break;
+    }
+
+    MoveGenKingLegal<cpcMove>(sqKing, bbTarget, vmv);
+
+    /* restrict everyone else to evasions when we're in check */
+    BB bbCheckers = BbAttackersTo(sqKing, ~cpcMove, bbOccupied);
+    if (bbCheckers) {
+        if (bbCheckers.csq() > 1)
+            return;
+        bbTarget &= bbCheckers | mpbb.BbBetween(sqKing, bbCheckers.sqLow());
+    }
+    else if (gen != GEN::Noisy) {
+        int8_t icpbdKing = IcpbdFromSq(sqKing);
+        if (csCur & Cs(csKing, cpcMove))
+            AddCastle<cpcMove>(icpbdKing, fiG, fiKingRook, fiF, csKing, vmv);
+        if (csCur & Cs(csQueen, cpcMove))
+            AddCastle<cpcMove>(icpbdKing, fiC, fiQueenRook, fiD, csQueen, vmv);
+    }
+
+    MoveGenPiecesLegal<cpcMove>(gen, sqKing, bbTarget, vmv);
+}
+
+/**
+ *  @fn         void BD::MoveGenEvasions(VMV& vmv) const
+ *  @brief      Generates the legal moves when the side to move is in check
+ * 
+ *  @details    Only three kinds of moves get out of check: the king stepping
+ *              to a square that isn't attacked, capturing the checking piece,
+ *              and blocking the line between a sliding checker and the king. 
+ *              In double check only the king can move. We never look at 
+ *              castles, and no other piece ever gets a destination outside 
+ *              the checker and the squares between.
+ */
+
+void BD::MoveGenEvasions(VMV& vmv) const noexcept
+{
+    if (cpcToMove == cpcWhite)
+        MoveGenEvasions<cpcWhite>(vmv);
+    else
+        MoveGenEvasions<cpcBlack>(vmv);
+}
+
+template <CPC cpcMove>
+void BD::MoveGenEvasions(VMV& vmv) const noexcept
+{
+    Validate();
     vmv.clear();
-    vmv.reserve(VMV::cmvGenMax);
 
+    SQ sqKing = SqKing(cpcMove);
+    BB bbCheckers = BbAttackersTo(sqKing, ~cpcMove, BbOccupied());
+    assert(bbCheckers);
+
+    MoveGenKingLegal<cpcMove>(sqKing, ~BbColor(cpcMove), vmv);
+    if (bbCheckers.csq() > 1)
+        return;
+
+    SQ sqChecker = bbCheckers.sqLow();
+    MoveGenPiecesLegal<cpcMove>(GEN::All, sqKing, bbCheckers | mpbb.BbBetween(sqKing, sqChecker), vmv);
+}
+
+/**
+ *  @fn         void BD::MoveGenQuietChecks(VMV& vmv) const
+ *  @brief      Adds the legal quiet moves that give check
+ * 
+ *  @details    Used by quiescent search to look at checks along with the
+ *              captures, so it appends to the move list rather than 
+ *              clearing it. The side to move must not be in check.
+ * 
+ *              Direct checks come from looking outward from the enemy king
+ *              with the knight, slider, and pawn attack tables; any piece 
+ *              that lands on one of those squares gives check. Discovered 
+ *              checks come from our pieces that are the only blocker 
+ *              between the enemy king and one of our sliders, which give 
+ *              check on any move that leaves the line. Promotions, castles, 
+ *              and en passant are left out; they're rare, and the noisy 
+ *              generator already has the promotions that capture.
+ */
+
+void BD::MoveGenQuietChecks(VMV& vmv) const noexcept
+{
+    if (cpcToMove == cpcWhite)
+        MoveGenQuietChecks<cpcWhite>(vmv);
+    else
+        MoveGenQuietChecks<cpcBlack>(vmv);
+}
+
+template <CPC cpcMove>
+void BD::MoveGenQuietChecks(VMV& vmv) const noexcept
+{
+    Validate();
+    assert(!FInCheck(cpcMove));
+
+    SQ sqKing = SqKing(cpcMove);
+    SQ sqKingEnemy = SqKing(~cpcMove);
+    BB bbOccupied = BbOccupied();
+    BB bbEmpty = ~bbOccupied;
+    BB bbPinned = BbPinned(cpcMove);
+    BB bbDiscover = BbBlockers(sqKingEnemy, cpcMove) & BbColor(cpcMove);
+
+    /* the squares each kind of piece gives check from */
+    BB bbPawnChecks = BbPawnAttacks(BB(sqKingEnemy), ~cpcMove);
+    BB bbKnightChecks = mpbb.BbKnightTo(sqKingEnemy);
+    BB bbBishopChecks = mpbb.BbBishopAttacks(sqKingEnemy, bbOccupied);
+    BB bbRookChecks = mpbb.BbRookAttacks(sqKingEnemy, bbOccupied);
+
+    /* pawn pushes */
+    constexpr int dsq = cpcMove == cpcWhite ? dsqNorth : dsqSouth;
+    for (BB bbPawns = BbPieces(cpcMove, cptPawn); bbPawns; bbPawns.ClearLow()) {
+        SQ sqFrom = bbPawns.sqLow();
+        SQ sqPush = (SQ)(sqFrom + dsq);
+        if (!(bbEmpty & sqPush) || ra(sqPush) == RaPromote(cpcMove))
+            continue;
+        BB bbTo = bbEmpty;
+        if (bbPinned & sqFrom)
+            bbTo &= mpbb.BbLine(sqKing, sqFrom);
+        BB bbChecks = bbPawnChecks;
+        if (bbDiscover & sqFrom)
+            bbChecks |= ~mpbb.BbLine(sqKingEnemy, sqFrom);
+        bbTo &= bbChecks;
+        if (bbTo & sqPush)
+            vmv.emplace_back(sqFrom, sqPush);
+        SQ sqDouble = (SQ)(sqPush + dsq);
+        if (ra(sqFrom) == RaPawns(cpcMove) && (bbEmpty & bbTo & sqDouble))
+            vmv.emplace_back(sqFrom, sqDouble);
+    }
+
+    /* pieces, and the king, which can only give discovered check */
     for (int icp = 0; icp < icpMax; icp++) {
-        int icpbdFrom = aicpbd[cpcToMove][icp];
+        int icpbdFrom = aicpbd[cpcMove][icp];
         if (icpbdFrom == -1)
             continue;
+        SQ sqFrom = SqFromIcpbd(icpbdFrom);
+        BB bbTo, bbChecks;
         switch (acpbd[icpbdFrom].cpt) {
-        case cptPawn:
-            MoveGenPawnNoisy(icpbdFrom, vmv);
-            break;
         case cptKnight:
-            MoveGenSingleNoisy(icpbdFrom, adicpbdKnight, size(adicpbdKnight), vmv);
+            bbTo = mpbb.BbKnightTo(sqFrom);
+            bbChecks = bbKnightChecks;
             break;
         case cptBishop:
-            MoveGenSliderNoisy(icpbdFrom, adicpbdBishop, size(adicpbdBishop), vmv);
+            bbTo = mpbb.BbBishopAttacks(sqFrom, bbOccupied);
+            bbChecks = bbBishopChecks;
             break;
         case cptRook:
-            MoveGenSliderNoisy(icpbdFrom, adicpbdRook, size(adicpbdRook), vmv);
+            bbTo = mpbb.BbRookAttacks(sqFrom, bbOccupied);
+            bbChecks = bbRookChecks;
             break;
-        case cptQueen: /* a queen is a sliding king */
-            MoveGenSliderNoisy(icpbdFrom, adicpbdKing, size(adicpbdKing), vmv);
+        case cptQueen:
+            bbTo = mpbb.BbQueenAttacks(sqFrom, bbOccupied);
+            bbChecks = bbBishopChecks | bbRookChecks;
             break;
         case cptKing:
-            MoveGenKingNoisy(icpbdFrom, vmv);
+            if (!(bbDiscover & sqFrom))
+                continue;
+            bbTo = mpbb.BbKingTo(sqFrom);
+            break;
+        default:
+            continue;
+        }
+        if (bbDiscover & sqFrom)
+            bbChecks |= ~mpbb.BbLine(sqKingEnemy, sqFrom);
+        bbTo &= bbEmpty & bbChecks;
+        if (bbPinned & sqFrom)
+            bbTo &= mpbb.BbLine(sqKing, sqFrom);
+        if (sqFrom != sqKing)
+            AddMoves(sqFrom, bbTo, vmv);
+        else
+            MoveGenKingLegal<cpcMove>(sqKing, bbTo, vmv);
+    }
+}
+
+/**
+ *  @fn         void BD::MoveGenKingLegal(SQ sqKing, BB bbTarget, VMV& vmv) const
+ *  @brief      Generates the king's legal non-castle moves to bbTarget
+ * 
+ *  @details    Destinations are tested against the attack map with the king
+ *              removed, so the king can't step backwards along the line of a
+ *              slider that's checking it.
+ */
+
+template <CPC cpcMove>
+void BD::MoveGenKingLegal(SQ sqKing, BB bbTarget, VMV& vmv) const noexcept
+{
+    BB bbOccupiedNoKing = BbOccupied() - BB(sqKing);
+    for (BB bbTo = mpbb.BbKingTo(sqKing) & bbTarget; bbTo; bbTo.ClearLow()) {
+        SQ sqTo = bbTo.sqLow();
+        if (!BbAttackersTo(sqTo, ~cpcMove, bbOccupiedNoKing))
+            vmv.emplace_back(sqKing, sqTo);
+    }
+}
+
+/**
+ *  @fn         void BD::MoveGenPiecesLegal(GEN gen, SQ sqKing, BB bbTarget, VMV& vmv) const
+ *  @brief      Generates the legal pawn and piece moves to bbTarget
+ * 
+ *  @details    Everything but the king. Pinned pieces are restricted to the
+ *              line through the king and the pinner.
+ */
+
+template <CPC cpcMove>
+void BD::MoveGenPiecesLegal(GEN gen, SQ sqKing, BB bbTarget, VMV& vmv) const noexcept
+{
+    BB bbOccupied = BbOccupied();
+    BB bbPinned = BbPinned(cpcMove);
+    MoveGenPawnsLegal<cpcMove>(gen, sqKing, bbTarget, bbPinned, vmv);
+
+    for (int icp = 0; icp < icpMax; icp++) {
+        int icpbdFrom = aicpbd[cpcMove][icp];
+        if (icpbdFrom == -1)
+            continue;
+        SQ sqFrom = SqFromIcpbd(icpbdFrom);
+        BB bbTo = bbTarget;
+        if (bbPinned & sqFrom)
+            bbTo &= mpbb.BbLine(sqKing, sqFrom);
+        switch (acpbd[icpbdFrom].cpt) {
+        case cptKnight:
+            AddMoves(sqFrom, mpbb.BbKnightTo(sqFrom) & bbTo, vmv);
+            break;
+        case cptBishop:
+            AddMoves(sqFrom, mpbb.BbBishopAttacks(sqFrom, bbOccupied) & bbTo, vmv);
+            break;
+        case cptRook:
+            AddMoves(sqFrom, mpbb.BbRookAttacks(sqFrom, bbOccupied) & bbTo, vmv);
+            break;
+        case cptQueen:
+            AddMoves(sqFrom, mpbb.BbQueenAttacks(sqFrom, bbOccupied) & bbTo, vmv);
             break;
         default:
-            assert(false);
             break;
         }
     }
 }
 
-void BD::RemoveChecks(VMV& vmv) const noexcept
+/**
+ *  @fn         void BD::MoveGenPawnsLegal(GEN gen, SQ sqKing, BB bbTarget, 
+ *                                         BB bbPinned, VMV& vmv) const
+ *  @brief      Generates legal pawn moves
+ * 
+ *  @details    bbTarget is the destination mask from the legal move generator, 
+ *              already restricted to evasions when we're in check. Pushes 
+ *              are never in the noisy target mask, and captures are never in
+ *              the quiet mask. En passant can expose the king along the rank 
+ *              of both pawns, so it gets a full check test instead of the 
+ *              masks.
+ */
+
+template <CPC cpcMove>
+void BD::MoveGenPawnsLegal(GEN gen, SQ sqKing, BB bbTarget, BB bbPinned, VMV& vmv) const noexcept
 {
-    int imvTo = 0;
-    BD bdT(*this);
-    for (int imv = 0; imv < vmv.size(); imv++) {
-        bdT.MakeMv(vmv[imv]);
-        if (bdT.FMvWasLegal())
-            vmv[imvTo++] = vmv[imv];
-        bdT.UndoMv();
+    BB bbEmpty = ~BbOccupied();
+    BB bbEnemy = BbColor(~cpcMove);
+    constexpr int dsq = cpcMove == cpcWhite ? dsqNorth : dsqSouth;
+
+    for (BB bbPawns = BbPieces(cpcMove, cptPawn); bbPawns; bbPawns.ClearLow()) {
+        SQ sqFrom = bbPawns.sqLow();
+        BB bbTo = bbTarget;
+        if (bbPinned & sqFrom)
+            bbTo &= mpbb.BbLine(sqKing, sqFrom);
+
+        /* pushes and double first pushes */
+        SQ sqPush = (SQ)(sqFrom + dsq);
+        if (gen != GEN::Noisy && (bbEmpty & sqPush)) {
+            if (bbTo & sqPush)
+                AddPawnMoves<cpcMove>(sqFrom, sqPush, vmv);
+            SQ sqDouble = (SQ)(sqPush + dsq);
+            if (ra(sqFrom) == RaPawns(cpcMove) && (bbEmpty & bbTo & sqDouble))
+                vmv.emplace_back(sqFrom, sqDouble);
+        }
+
+        /* captures */
+        BB bbAttacks = BbPawnAttacks(BB(sqFrom), cpcMove);
+        for (BB bbCapture = bbAttacks & bbEnemy & bbTo; bbCapture; bbCapture.ClearLow())
+            AddPawnMoves<cpcMove>(sqFrom, bbCapture.sqLow(), vmv);
+        if (gen != GEN::Quiet && sqEnPassant != sqNil && (bbAttacks & sqEnPassant) && 
+                FEnPassantLegal(sqFrom, sqKing))
+            vmv.emplace_back(sqFrom, sqEnPassant);
+    }
+}
+
+/**
+ *  @fn         bool BD::FMvIsLegal(const MV& mv) const
+ *  @brief      Checks if a move that didn't come from the move generator is
+ *              legal in this position
+ * 
+ *  @details    Used for moves that come out of the transposition and killer
+ *              tables, which may come from a different position, and we want
+ *              to try them before we generate the move list. Uses the same 
+ *              pin and check masks as the legal move generator.
+ */
+
+bool BD::FMvIsLegal(const MV& mv) const noexcept
+{
+    if (mv.sqFrom >= sqMax || mv.sqTo >= sqMax)
+        return false;
+    const CPBD& cpbdFrom = acpbd[IcpbdFromSq(mv.sqFrom)];
+    if (cpbdFrom.cpc != cpcToMove)
+        return false;
+
+    SQ sqKing = SqKing(cpcToMove);
+    BB bbOccupied = BbOccupied();
+    BB bbTo = ~BbColor(cpcToMove);
+
+    /* castles are rare enough that we just ask the generator */
+    if (mv.csMove != csNone) {
+        if (mv.sqFrom != sqKing || !(csCur & Cs(mv.csMove, cpcToMove)) || 
+                BbAttackersTo(sqKing, ~cpcToMove, bbOccupied))
+            return false;
+        VMV vmv;
+        int8_t icpbdKing = IcpbdFromSq(sqKing);
+        int8_t fiKingTo = mv.csMove == csKing ? fiG : fiC;
+        int8_t fiRookFrom = mv.csMove == csKing ? fiKingRook : fiQueenRook;
+        int8_t fiRookTo = mv.csMove == csKing ? fiF : fiD;
+        if (cpcToMove == cpcWhite)
+            AddCastle<cpcWhite>(icpbdKing, fiKingTo, fiRookFrom, fiRookTo, mv.csMove, vmv);
+        else
+            AddCastle<cpcBlack>(icpbdKing, fiKingTo, fiRookFrom, fiRookTo, mv.csMove, vmv);
+        return vmv.size() == 1 && vmv[0] == mv;
+    }
+
+    if (cpbdFrom.cpt == cptPawn) {
+        if ((mv.cptPromote != cptNone) != (ra(mv.sqTo) == RaPromote(cpcToMove)))
+            return false;
+        if (mv.sqTo == sqEnPassant)
+            return (BbPawnAttacks(BB(mv.sqFrom), cpcToMove) & mv.sqTo) && 
+                   FEnPassantLegal(mv.sqFrom, sqKing);
+        int dsq = cpcToMove == cpcWhite ? dsqNorth : dsqSouth;
+        BB bbEmpty = ~bbOccupied;
+        BB bbPawnTo = BbPawnAttacks(BB(mv.sqFrom), cpcToMove) & BbColor(~cpcToMove);
+        SQ sqPush = (SQ)(mv.sqFrom + dsq);
+        if (bbEmpty & sqPush) {
+            bbPawnTo |= sqPush;
+            if (ra(mv.sqFrom) == RaPawns(cpcToMove))
+                bbPawnTo |= bbEmpty & (SQ)(sqPush + dsq);
+        }
+        bbTo &= bbPawnTo;
+    }
+    else {
+        if (mv.cptPromote != cptNone)
+            return false;
+        switch (cpbdFrom.cpt) {
+        case cptKnight:
+            bbTo &= mpbb.BbKnightTo(mv.sqFrom);
+            break;
+        case cptBishop:
+            bbTo &= mpbb.BbBishopAttacks(mv.sqFrom, bbOccupied);
+            break;
+        case cptRook:
+            bbTo &= mpbb.BbRookAttacks(mv.sqFrom, bbOccupied);
+            break;
+        case cptQueen:
+            bbTo &= mpbb.BbQueenAttacks(mv.sqFrom, bbOccupied);
+            break;
+        case cptKing:
+            return (mpbb.BbKingTo(mv.sqFrom) & bbTo & mv.sqTo) &&
+                   !BbAttackersTo(mv.sqTo, ~cpcToMove, bbOccupied - BB(sqKing));
+        default:
+            return false;
+        }
     }
-    vmv.resize(imvTo);
+    if (!(bbTo & mv.sqTo))
+        return false;
+
+    /* the move is pseudo-legal; now make sure it gets out of check and doesn't
+       break a pin */
+    BB bbCheckers = BbAttackersTo(sqKing, ~cpcToMove, bbOccupied);
+    if (bbCheckers) {
+        if (bbCheckers.csq() > 1)
+            return false;
+        if (!((bbCheckers | mpbb.BbBetween(sqKing, bbCheckers.sqLow())) & mv.sqTo))
+            return false;
+    }
+    if (BbPinned(cpcToMove) & mv.sqFrom)
+        return (bool)(mpbb.BbLine(sqKing, mv.sqFrom) & mv.sqTo);
+    return true;
+}
+
+/**
+ *  @fn         bool BD::FEnPassantLegal(SQ sqFrom, SQ sqKing) const
+ *  @brief      Checks if an en passant capture leaves our king safe
+ * 
+ *  @details    Two pawns leave the rank at once, which the pin masks don't
+ *              handle, so we just build the occupancy after the capture and 
+ *              look for attackers. This also takes care of capturing a pawn 
+ *              that just gave check with its double push.
+ */
+
+bool BD::FEnPassantLegal(SQ sqFrom, SQ sqKing) const noexcept
+{
+    SQ sqTake = Sq(fi(sqEnPassant), ra(sqFrom));
+    BB bbOccupied = (BbOccupied() - BB(sqFrom) - BB(sqTake)) | sqEnPassant;
+    return !(BbAttackersTo(sqKing, ~cpcToMove, bbOccupied) - BB(sqTake));
 }
 
 bool BD::FMvWasLegal(void) const noexcept
 {
     const MVU& mvu = vmvuGame.back();
-    if (mvu.csMove) {
+    if (mvu.csMove()) {
         /* check test for casltes */
-        int icpbdKingFrom = IcpbdFromSq(mvu.sqFrom);
-        int icpbdKingTo = IcpbdFromSq(mvu.sqTo);
+        int icpbdKingFrom = IcpbdFromSq(mvu.sqFrom());
+        int icpbdKingTo = IcpbdFromSq(mvu.sqTo());
         if (icpbdKingFrom > icpbdKingTo)
             swap(icpbdKingFrom, icpbdKingTo);
         for (int icpbd = icpbdKingFrom; icpbd <= icpbdKingTo; icpbd++)
@@ -196,56 +600,55 @@ bool BD::FMvIsNoisy(const MV& mv) const noexcept
 
 bool BD::FMvWasNoisy(void) const noexcept
 {
-    return cpt(vmvuGame.back().cpTake) != cptNone && vmvuGame.back().cptPromote != cptNone;
+    return cpt(vmvuGame.back().cpTake) != cptNone || vmvuGame.back().cptPromote() != cptNone;
 }
 
+template <CPC cpcMove>
 void BD::MoveGenPawn(int8_t icpbdFrom, VMV& vmv) const noexcept
 {
-    int dicpbd = (cpcToMove == cpcWhite) ? 10 : -10;
+    constexpr int dicpbd = cpcMove == cpcWhite ? 10 : -10;
     int icpbdTo = icpbdFrom + dicpbd;
 
     /* regular forward moves anmd double first moves */
     if (acpbd[icpbdTo].cp() == cpEmpty) {
-        AddPawnMoves(icpbdFrom, icpbdTo, vmv);
+        AddPawnMoves<cpcMove>(icpbdFrom, icpbdTo, vmv);
         int raFrom = ra(SqFromIcpbd(icpbdFrom));
-        if (raFrom == RaPawns(cpcToMove) && acpbd[icpbdTo + dicpbd].cp() == cpEmpty)
+        if (raFrom == RaPawns(cpcMove) && acpbd[icpbdTo + dicpbd].cp() == cpEmpty)
             vmv.emplace_back(icpbdFrom, icpbdTo + dicpbd); // can't be a promotion 
     }
     
-    MoveGenPawnNoisy(icpbdFrom, vmv);
+    MoveGenPawnNoisy<cpcMove>(icpbdFrom, vmv);
 }
 
+template <CPC cpcMove>
 void BD::MoveGenPawnNoisy(int8_t icpbdFrom, VMV& vmv) const noexcept
 {
-    int dicpbd = (cpcToMove == cpcWhite) ? 10 : -10;
+    constexpr int dicpbd = cpcMove == cpcWhite ? 10 : -10;
     int icpbdTo = icpbdFrom + dicpbd;
 
     /* captures, including en passant */
-    if (acpbd[icpbdTo - 1].cpc == ~cpcToMove)
-        AddPawnMoves(icpbdFrom, icpbdTo - 1, vmv);
-    if (acpbd[icpbdTo + 1].cpc == ~cpcToMove)
-        AddPawnMoves(icpbdFrom, icpbdTo + 1, vmv);
+    if (acpbd[icpbdTo - 1].cpc == ~cpcMove)
+        AddPawnMoves<cpcMove>(icpbdFrom, icpbdTo - 1, vmv);
+    if (acpbd[icpbdTo + 1].cpc == ~cpcMove)
+        AddPawnMoves<cpcMove>(icpbdFrom, icpbdTo + 1, vmv);
     if (sqEnPassant != sqNil) {
         int icpbd = IcpbdFromSq(sqEnPassant);
         if (icpbd == icpbdTo - 1)
-            AddPawnMoves(icpbdFrom, icpbdTo - 1, vmv);
+            AddPawnMoves<cpcMove>(icpbdFrom, icpbdTo - 1, vmv);
         if (icpbd == icpbdTo + 1)
-            AddPawnMoves(icpbdFrom, icpbdTo + 1, vmv);
+            AddPawnMoves<cpcMove>(icpbdFrom, icpbdTo + 1, vmv);
     }
 }
 
+template <CPC cpcMove>
 void BD::MoveGenKing(int8_t icpbdFrom, VMV& vmv) const noexcept
 {
-    MoveGenSingle(icpbdFrom, adicpbdKing, size(adicpbdKing), vmv);
-    if (csCur & Cs(csKing, cpcToMove))
-        AddCastle(icpbdFrom, fiG, fiKingRook, fiF, csKing, vmv);
-    if (csCur & Cs(csQueen, cpcToMove))
-        AddCastle(icpbdFrom, fiC, fiQueenRook, fiD, csQueen, vmv);
-}
-
-void BD::MoveGenKingNoisy(int8_t icpbdFrom, VMV& vmv) const noexcept
-{
-    MoveGenSingleNoisy(icpbdFrom, adicpbdKing, size(adicpbdKing), vmv);
+    SQ sqFrom = SqFromIcpbd(icpbdFrom);
+    AddMoves(sqFrom, mpbb.BbKingTo(sqFrom) - BbColor(cpcMove), vmv);
+    if (csCur & Cs(csKing, cpcMove))
+        AddCastle<cpcMove>(icpbdFrom, fiG, fiKingRook, fiF, csKing, vmv);
+    if (csCur & Cs(csQueen, cpcMove))
+        AddCastle<cpcMove>(icpbdFrom, fiC, fiQueenRook, fiD, csQueen, vmv);
 }
 
 /**
@@ -279,11 +682,12 @@ void BD::MoveGenKingNoisy(int8_t icpbdFrom, VMV& vmv) const noexcept
  *                     have some other piece in it King can't move through 
  *                     check, or be in check.
  *
- *              Check verification is not done here - that the king is not in 
- *              check, does not move through check, and does not end up in 
- *              check - it's done in FMvWasLegal.
+ *              We check here that the king does not move through check or end
+ *              up in check, using the occupancy after the castle. The caller 
+ *              is responsible for making sure we're not castling out of check.
  */
 
+template <CPC cpcMove>
 void BD::AddCastle(int8_t icpbdKingFrom, int8_t fiKingTo, int8_t fiRookFrom, int8_t fiRookTo, CS csMove, VMV& vmv) const noexcept
 {
     /* NOTE: this all gets simpler with bitboards so I haven't killed myself 
@@ -300,6 +704,12 @@ void BD::AddCastle(int8_t icpbdKingFrom, int8_t fiKingTo, int8_t fiRookFrom, int
         if (icpbd != icpbdRookFrom && icpbd != icpbdKingFrom && acpbd[icpbd].cp() != cpEmpty)
             return;
 
+    BB bbOccupied = BbOccupied() - BB(SqFromIcpbd(icpbdKingFrom)) - BB(SqFromIcpbd(icpbdRookFrom));
+    bbOccupied |= BB(SqFromIcpbd(icpbdKingTo)) | BB(SqFromIcpbd(icpbdRookTo));
+    for (int8_t icpbd = min(icpbdKingFrom, icpbdKingTo); icpbd <= max(icpbdKingFrom, icpbdKingTo); icpbd++)
+        if (BbAttackersTo(SqFromIcpbd(icpbd), ~cpcMove, bbOccupied))
+            return;
+
     vmv.emplace_back(icpbdKingFrom, icpbdKingTo, csMove);
 }
 
@@ -310,10 +720,11 @@ void BD::AddCastle(int8_t icpbdKingFrom, int8_t fiKingTo, int8_t fiRookFrom, int
  *  @details    For promotions, this will add the four promotion possibilities.
  */
 
+template <CPC cpcMove>
 void BD::AddPawnMoves(int8_t icpbdFrom, int8_t icpbdTo, VMV& vmv) const noexcept
 {
     int raTo = ra(SqFromIcpbd(icpbdTo));
-    if (raTo != RaPromote(cpcToMove))
+    if (raTo != RaPromote(cpcMove))
         vmv.emplace_back(icpbdFrom, icpbdTo);
     else {
         vmv.emplace_back(icpbdFrom, icpbdTo, cptQueen);
@@ -323,74 +734,31 @@ void BD::AddPawnMoves(int8_t icpbdFrom, int8_t icpbdTo, VMV& vmv) const noexcept
     }
 }
 
-/**
- *  @fn         void BD::MoveGenSlider(int8_t icpbdFrom, 
- *                                     const int8_t adicpbd[], int8_t cdicpbd, 
- *                                     VMV& vmv) const
- *  @brief      Generates sliding piece moves
- * 
- *  @details    Generates all moves of a sliding piece (rook, bishop, queen) 
- *              in one particular direction
- */
-
-void BD::MoveGenSlider(int8_t icpbdFrom, const int8_t adicpbd[], int8_t cdicpbd, VMV& vmv) const noexcept
-{
-    for (int idicpbd = 0; idicpbd < cdicpbd; idicpbd++) {
-        int dicpbd = adicpbd[idicpbd];
-        for (int icpbdTo = icpbdFrom + dicpbd; ; icpbdTo += dicpbd) {
-            CP cp = acpbd[icpbdTo].cp();
-            if (cp == cpInvalid || cpc(cp) == cpcToMove)
-                break;
-            vmv.emplace_back(icpbdFrom, icpbdTo);
-            if (cpc(cp) == ~cpcToMove)
-                break;
-        }
-    }
-}
-
-void BD::MoveGenSliderNoisy(int8_t icpbdFrom, const int8_t adicpbd[], int8_t cdicpbd, VMV& vmv) const noexcept
+template <CPC cpcMove>
+void BD::AddPawnMoves(SQ sqFrom, SQ sqTo, VMV& vmv) const noexcept
 {
-    for (int idicpbd = 0; idicpbd < cdicpbd; idicpbd++) {
-        int dicpbd = adicpbd[idicpbd];
-        for (int icpbdTo = icpbdFrom + dicpbd; ; icpbdTo += dicpbd) {
-            CP cp = acpbd[icpbdTo].cp();
-            if (cp == cpInvalid || cpc(cp) == cpcToMove)
-                break;
-            if (cpc(cp) == ~cpcToMove) {
-                vmv.emplace_back(icpbdFrom, icpbdTo);
-                break;
-            }
-        }
+    if (ra(sqTo) != RaPromote(cpcMove))
+        vmv.emplace_back(sqFrom, sqTo);
+    else {
+        vmv.emplace_back(sqFrom, sqTo, cptQueen);
+        vmv.emplace_back(sqFrom, sqTo, cptRook);
+        vmv.emplace_back(sqFrom, sqTo, cptBishop);
+        vmv.emplace_back(sqFrom, sqTo, cptKnight);
     }
 }
 
 /**
- *  @fn         void BD::MoveGenSingle(int8_t icpbdFrom,
- *                                     const int8_t adicpbd[], int8_t cdicpbd,
- *                                     VMV& vmv) const
- *  @brief      Generates moves for kings and knights
+ *  @fn         void BD::AddMoves(SQ sqFrom, BB bbTo, VMV& vmv) const
+ *  @brief      Adds moves from a square to every square in a bitboard
  * 
- *  @details    Just grinds through all the possible destination squares
+ *  @details    Used for all the pieces except pawns, whose destination 
+ *              squares come straight out of the attack tables.
  */
 
-void BD::MoveGenSingle(int8_t icpbdFrom, const int8_t adicpbd[], int8_t cdicpbd, VMV& vmv) const noexcept
+void BD::AddMoves(SQ sqFrom, BB bbTo, VMV& vmv) const noexcept
 {
-    for (int8_t idicpbd = 0; idicpbd < cdicpbd; idicpbd++) {
-        int8_t icpbdTo = icpbdFrom + adicpbd[idicpbd];
-        CP cp = acpbd[icpbdTo].cp();
-        if (cp == cpEmpty || cpc(cp) == ~cpcToMove)
-            vmv.emplace_back(icpbdFrom, icpbdTo);
-    }
-}
-
-void BD::MoveGenSingleNoisy(int8_t icpbdFrom, const int8_t adicpbd[], int8_t cdicpbd, VMV& vmv) const noexcept
-{
-    for (int8_t idicpbd = 0; idicpbd < cdicpbd; idicpbd++) {
-        int8_t icpbdTo = icpbdFrom + adicpbd[idicpbd];
-        CP cp = acpbd[icpbdTo].cp();
-        if (cpc(cp) == ~cpcToMove)
-            vmv.emplace_back(icpbdFrom, icpbdTo);
-    }
+    for (; bbTo; bbTo.ClearLow())
+        vmv.emplace_back(sqFrom, bbTo.sqLow());
 }
 
 /**
@@ -400,7 +768,7 @@ void BD::MoveGenSingleNoisy(int8_t icpbdFrom, const int8_t adicpbd[], int8_t cdi
 
 bool BD::FInCheck(CPC cpc) const noexcept
 {
-    return FIsAttackedBy(IcpbdFindKing(cpc), ~cpc);
+    return BbAttackersTo(SqKing(cpc), ~cpc, BbOccupied());
 }
 
 /**
@@ -408,19 +776,24 @@ bool BD::FInCheck(CPC cpc) const noexcept
  *  @brief      Checks if a square is attacked
  * 
  *  @details    Checks if the square is under attack by a piece of color cpcBy.
+ *              Attacks are symmetric, so we look from the attacked square for 
+ *              pieces that could reach it.
  */
 
 bool BD::FIsAttackedBy(int8_t icpbdAttacked, CPC cpcBy) const noexcept
 {
-    if (FIsAttackedBySlider(icpbdAttacked, ((1 << cptRook) | (1 << cptQueen)) << (cpcBy << 3), adicpbdRook, size(adicpbdRook)))
+    SQ sqAttacked = SqFromIcpbd(icpbdAttacked);
+    if (mpbb.BbKnightTo(sqAttacked) & BbPieces(cpcBy, cptKnight))
         return true;
-    if (FIsAttackedBySlider(icpbdAttacked, ((1<<cptBishop)|(1<<cptQueen)) << (cpcBy<<3), adicpbdBishop, size(adicpbdBishop)))
+    if (BbPawnAttacks(BB(sqAttacked), ~cpcBy) & BbPieces(cpcBy, cptPawn))
         return true;
-    if (FIsAttackedBySingle(icpbdAttacked, Cp(cpcBy, cptKnight), adicpbdKnight, size(adicpbdKnight)))
+    if (mpbb.BbKingTo(sqAttacked) & BbPieces(cpcBy, cptKing))
         return true;
-    if (FIsAttackedBySingle(icpbdAttacked, Cp(cpcBy, cptPawn), &adicpbdPawn[(~cpcBy) * 2], 2))
+    BB bbOccupied = BbOccupied();
+    BB bbQueens = BbPieces(cpcBy, cptQueen);
+    if (mpbb.BbRookAttacks(sqAttacked, bbOccupied) & (BbPieces(cpcBy, cptRook) | bbQueens))
         return true;
-    if (FIsAttackedBySingle(icpbdAttacked, Cp(cpcBy, cptKing), adicpbdKing, size(adicpbdKing)))
+    if (mpbb.BbBishopAttacks(sqAttacked, bbOccupied) & (BbPieces(cpcBy, cptBishop) | bbQueens))
         return true;
     return false;
 }
@@ -432,59 +805,162 @@ bool BD::FIsAttackedBy(int8_t icpbdAttacked, CPC cpcBy) const noexcept
 
 CPT BD::CptSqAttackedBy(SQ sq, CPC cpcBy) const noexcept
 {
-    int8_t icpbdAttacked = IcpbdFromSq(sq);
-    if (FIsAttackedBySingle(icpbdAttacked, Cp(cpcBy, cptPawn), &adicpbdPawn[(~cpcBy) * 2], 2))
+    if (BbPawnAttacks(BB(sq), ~cpcBy) & BbPieces(cpcBy, cptPawn))
         return cptPawn;
-    if (FIsAttackedBySingle(icpbdAttacked, Cp(cpcBy, cptKnight), adicpbdKnight, size(adicpbdKnight)))
+    if (mpbb.BbKnightTo(sq) & BbPieces(cpcBy, cptKnight))
         return cptKnight;
-    if (FIsAttackedBySlider(icpbdAttacked, (1 << cptBishop) << (cpcBy << 3), adicpbdBishop, size(adicpbdBishop)))
+    BB bbOccupied = BbOccupied();
+    BB bbBishopAttacks = mpbb.BbBishopAttacks(sq, bbOccupied);
+    if (bbBishopAttacks & BbPieces(cpcBy, cptBishop))
         return cptBishop;
-    if (FIsAttackedBySlider(icpbdAttacked, (1 << cptRook) << (cpcBy << 3), adicpbdRook, size(adicpbdRook)))
+    BB bbRookAttacks = mpbb.BbRookAttacks(sq, bbOccupied);
+    if (bbRookAttacks & BbPieces(cpcBy, cptRook))
         return cptRook;
-    if (FIsAttackedBySlider(icpbdAttacked, (1 << cptQueen) << (cpcBy << 3), adicpbdQueen, size(adicpbdQueen)))
+    if ((bbBishopAttacks | bbRookAttacks) & BbPieces(cpcBy, cptQueen))
         return cptQueen;
-    if (FIsAttackedBySingle(icpbdAttacked, Cp(cpcBy, cptKing), adicpbdKing, size(adicpbdKing)))
+    if (mpbb.BbKingTo(sq) & BbPieces(cpcBy, cptKing))
         return cptKing;
     return cptNone;
 }
 
-bool BD::FIsAttackedBySingle(int8_t icpbdAttacked, CP cp, const int8_t adicpbd[], int8_t cdicpbd) const noexcept
+/**
+ *  @fn         BB BD::BbAttackersTo(SQ sq, CPC cpcBy, BB bbOccupied) const
+ *  @brief      All the pieces of color cpcBy that attack a square
+ * 
+ *  @details    Sliders are blocked by the pieces in bbOccupied instead of 
+ *              the board's own occupancy, so callers can ask what would be
+ *              attacking the square after pieces move.
+ */
+
+BB BD::BbAttackersTo(SQ sq, CPC cpcBy, BB bbOccupied) const noexcept
 {
-    for (int8_t idicpbd = 0; idicpbd < cdicpbd; idicpbd++) {
-        if (acpbd[icpbdAttacked + adicpbd[idicpbd]].cp() == cp)
-            return true;
-    }
-    return false;
+    BB bbQueens = BbPieces(cpcBy, cptQueen);
+    return (BbPawnAttacks(BB(sq), ~cpcBy) & BbPieces(cpcBy, cptPawn)) |
+           (mpbb.BbKnightTo(sq) & BbPieces(cpcBy, cptKnight)) |
+           (mpbb.BbKingTo(sq) & BbPieces(cpcBy, cptKing)) |
+           (mpbb.BbRookAttacks(sq, bbOccupied) & (BbPieces(cpcBy, cptRook) | bbQueens)) |
+           (mpbb.BbBishopAttacks(sq, bbOccupied) & (BbPieces(cpcBy, cptBishop) | bbQueens));
 }
 
-bool BD::FIsAttackedBySlider(int8_t icpbdAttacked, uint16_t grfCp, const int8_t adicpbd[], int8_t cdicpbd) const noexcept
+/**
+ *  @fn         bool BD::SeeGe(const MV& mv, EV evThreshold) const
+ *  @brief      Static exchange evaluation
+ *
+ *  @details    Returns true if the sequence of captures on the destination
+ *              square started by mv wins at least evThreshold for the side
+ *              to move, assuming both sides always recapture with their
+ *              least valuable piece and either side may stop when it's
+ *              ahead. Sliders hiding behind a piece that captures are
+ *              discovered as the exchange goes on. Pins are ignored.
+ *
+ *              Rather than building the whole swap list, we keep a running
+ *              balance relative to the threshold and stop as soon as one
+ *              side can't come out ahead.
+ */
+
+static constexpr EV mpcptevSee[cptMax] = { 0, 100, 300, 300, 500, 900, 0 };
+
+bool BD::SeeGe(const MV& mv, EV evThreshold) const noexcept
 {
-    for (int8_t idicpbd = 0; idicpbd < cdicpbd; idicpbd++) {
-        int8_t dicpbd = adicpbd[idicpbd];
-        for (int8_t icpbd = icpbdAttacked + dicpbd; ; icpbd += dicpbd) {
-            if ((1 << acpbd[icpbd].cp()) & grfCp)
-                return true;
-            if (acpbd[icpbd].cp() != cpEmpty)
+    if (mv.csMove)
+        return evThreshold <= 0;
+
+    CPT cptMove = (CPT)(*this)[mv.sqFrom].cpt;
+    CPT cptTake = (CPT)(*this)[mv.sqTo].cpt;
+    BB bbOccupied = (BbOccupied() - BB(mv.sqFrom)) | mv.sqTo;
+    if (cptMove == cptPawn && mv.sqTo == sqEnPassant) {
+        cptTake = cptPawn;
+        bbOccupied -= BB(SQ(mv.sqTo + (cpcToMove == cpcWhite ? -8 : 8)));
+    }
+
+    /* what we win if the capture isn't answered */
+    int evSwap = mpcptevSee[cptTake] - evThreshold;
+    if (mv.cptPromote != cptNone) {
+        evSwap += mpcptevSee[mv.cptPromote] - mpcptevSee[cptPawn];
+        cptMove = mv.cptPromote;
+    }
+    if (evSwap < 0)
+        return false;
+
+    /* what we're left with if our piece is taken for free */
+    evSwap = mpcptevSee[cptMove] - evSwap;
+    if (evSwap <= 0)
+        return true;
+
+    BB bbAttackers = BbAttackersTo(mv.sqTo, cpcWhite, bbOccupied) |
+                     BbAttackersTo(mv.sqTo, cpcBlack, bbOccupied);
+    BB bbDiagonal = BbPieces(cptBishop) | BbPieces(cptQueen);
+    BB bbOrthogonal = BbPieces(cptRook) | BbPieces(cptQueen);
+    CPC cpcSide = cpcToMove;
+    int fWin = 1;
+
+    for (;;) {
+        cpcSide = ~cpcSide;
+        bbAttackers &= bbOccupied;
+        BB bbSide = bbAttackers & BbColor(cpcSide);
+        if (!bbSide)
+            break;
+        fWin ^= 1;
+
+        /* capture with the least valuable attacker, and look for sliders
+           behind it */
+        CPT cptAttacker;
+        BB bbAttacker;
+        for (cptAttacker = cptPawn; cptAttacker < cptKing; ++cptAttacker)
+            if ((bbAttacker = bbSide & BbPieces(cptAttacker)))
                 break;
+        if (cptAttacker == cptKing) {
+            /* the king can only take if the other side has run out */
+            return (bbAttackers & BbColor(~cpcSide)) ? !fWin : fWin;
         }
+
+        evSwap = mpcptevSee[cptAttacker] - evSwap;
+        if (evSwap < fWin)
+            break;
+        bbOccupied -= BB(bbAttacker.sqLow());
+        if (cptAttacker == cptPawn || cptAttacker == cptBishop || cptAttacker == cptQueen)
+            bbAttackers |= mpbb.BbBishopAttacks(mv.sqTo, bbOccupied) & bbDiagonal;
+        if (cptAttacker == cptRook || cptAttacker == cptQueen)
+            bbAttackers |= mpbb.BbRookAttacks(mv.sqTo, bbOccupied) & bbOrthogonal;
     }
-    return false;
+
+    return fWin;
+}
+
+/**
+ *  @fn         BB BD::BbPinned(CPC cpc) const
+ *  @brief      The pieces of color cpc that are pinned against their king
+ */
+
+BB BD::BbPinned(CPC cpc) const noexcept
+{
+    return BbBlockers(SqKing(cpc), ~cpc) & BbColor(cpc);
 }
 
 /**
- *  @fn         int8_t BD::IcpbdFromKing(CPC cpc) const
- *  @brief      Finds the position of the king on the board
+ *  @fn         BB BD::BbBlockers(SQ sqKing, CPC cpcSniper) const
+ *  @brief      The pieces that are the only thing standing between a king 
+ *              and a slider of color cpcSniper
+ * 
+ *  @details    Looks for sliders that would attack the king on an empty
+ *              board, and then for a single piece between them. Blockers of
+ *              the king's own color are pinned; blockers of the sniper's 
+ *              color give discovered check when they move off the line.
  */
 
-int8_t BD::IcpbdFindKing(CPC cpc) const noexcept
+BB BD::BbBlockers(SQ sqKing, CPC cpcSniper) const noexcept
 {
-    for (int8_t icp = 0; icp < icpMax; icp++) {
-        int8_t icpbd = aicpbd[cpc][icp];
-        if (icpbd != -1 && acpbd[icpbd].cpt == cptKing)
-            return icpbd;
+    BB bbOccupied = BbOccupied();
+    BB bbQueens = BbPieces(cpcSniper, cptQueen);
+    BB bbSnipers = (mpbb.BbRookAttacks(sqKing, BB()) & (BbPieces(cpcSniper, cptRook) | bbQueens)) |
+                   (mpbb.BbBishopAttacks(sqKing, BB()) & (BbPieces(cpcSniper, cptBishop) | bbQueens));
+    BB bbBlockers;
+    for (; bbSnipers; bbSnipers.ClearLow()) {
+        BB bbBetween = mpbb.BbBetween(sqKing, bbSnipers.sqLow()) & bbOccupied;
+        if (bbBetween.csq() == 1)
+            bbBlockers |= bbBetween;
     }
-    assert(false);
-    return -1;
+    return bbBlockers;
 }
 
 /**
@@ -914,6 +914,7 @@ DLGAISETTINGS::DLGAISETTINGS(WN& wnParent, const SETAI& set) :
     chkFutilityPruning(*this, rssAISettingsFutilityPruning),
     chkLateMovePruning(*this, rssAISettingsLateMovePruning),
     chkLateMoveReduction(*this, rssAISettingsLateMoveReduction),
+    chkInternalIterativeReduction(*this, rssAISettingsInternalIterativeReduction),
 
     groupMoveOrder(*this, rssAISettingsMoveOrderGroup),
     chkKillers(*this, rssAISettingsKillers),
@@ -930,15 +931,17 @@ DLGAISETTINGS::DLGAISETTINGS(WN& wnParent, const SETAI& set) :
     groupOther(*this, rssAISettingsOtherGroup),
     chkPV(*this, rssAISettingsPV),
     chkAspiration(*this, rssAISettingsAspiration),
+    chkQuiescentChecks(*this, rssAISettingsQuiescentChecks),
+    chkSingularExtension(*this, rssAISettingsSingularExtension),
     editXt(*this, "", rssAISettingsXtSize),
     editDepthMax(*this, "", rssAISettingsDepthMax),
 
     btnok(*this)
 {
-    groupPrune.AddToGroup(chkRevFutility, chkRazoring, chkNullMove, chkFutilityPruning, chkLateMovePruning, chkLateMoveReduction);
+    groupPrune.AddToGroup(chkRevFutility, chkRazoring, chkNullMove, chkFutilityPruning, chkLateMovePruning, chkLateMoveReduction, chkInternalIterativeReduction);
     groupMoveOrder.AddToGroup(chkKillers, chkHistory);
     groupEval.AddToGroup(chkPSQT, chkMaterial, chkMobility, chkKingSafety, chkPawnStructure, chkTempo);
-    groupOther.AddToGroup(chkPV, chkAspiration, editXt, editDepthMax);
+    groupOther.AddToGroup(chkPV, chkAspiration, chkQuiescentChecks, chkSingularExtension, editXt, editDepthMax);
 
     Init(set);
 }
@@ -951,6 +954,7 @@ void DLGAISETTINGS::Init(const SETAI& set)
     chkFutilityPruning.SetValue(set.fFutilityPruning);
     chkLateMovePruning.SetValue(set.fLateMovePruning);
     chkLateMoveReduction.SetValue(set.fLateMoveReduction);
+    chkInternalIterativeReduction.SetValue(set.fInternalIterativeReduction);
 
     chkKillers.SetValue(set.fKillers);
     chkHistory.SetValue(set.fHistory);
@@ -964,6 +968,8 @@ void DLGAISETTINGS::Init(const SETAI& set)
 
     chkPV.SetValue(set.fPV);
     chkAspiration.SetValue(set.fAspiration);
+    chkQuiescentChecks.SetValue(set.fQuiescentChecks);
+    chkSingularExtension.SetValue(set.fSingularExtension);
     editXt.SetText(to_string(set.cmbXt));
     editDepthMax.SetText(to_string(set.dMax - 1));
 }
@@ -976,6 +982,7 @@ void DLGAISETTINGS::Extract(SETAI& set)
     set.fFutilityPruning = chkFutilityPruning.ValueGet();
     set.fLateMovePruning = chkLateMovePruning.ValueGet();
     set.fLateMoveReduction = chkLateMoveReduction.ValueGet();
+    set.fInternalIterativeReduction = chkInternalIterativeReduction.ValueGet();
 
     set.fKillers = chkKillers.ValueGet();
     set.fHistory = chkHistory.ValueGet();
@@ -989,6 +996,8 @@ void DLGAISETTINGS::Extract(SETAI& set)
     
     set.fPV = chkPV.ValueGet();
     set.fAspiration = chkAspiration.ValueGet();
+    set.fQuiescentChecks = chkQuiescentChecks.ValueGet();
+    set.fSingularExtension = chkSingularExtension.ValueGet();
     /* TODO: should do some real parsing/validation here */
     try {
         set.cmbXt = stoi(editXt.SText());
@@ -0,0 +1,391 @@
+/**
+ *  @file       perft.cpp
+ *  @brief      Hashed, multithreaded perft and the perft test suite
+ *
+ *  @details    Perft is our move generator correctness test. Counting every
+ *              leaf of the tree gets expensive fast, but perft trees are full
+ *              of transpositions, so a table of node counts keyed on the board
+ *              hash and depth cuts out most of the work. The root moves are
+ *              independent of each other and are handed out to a pool of
+ *              threads, each with its own copy of the board, all sharing the
+ *              one table. The threads live as long as the PERFT does.
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "perft.h"
+
+/**
+ *  @fn         PERFT::PERFT(uint32_t cmbHash, int cthread)
+ *  @brief      Creates the perft engine
+ *
+ *  @details    The table size is in megabytes and is rounded down to a power
+ *              of two. A thread count of 0 uses one thread per hardware 
+ *              thread. The calling thread does its share of the work, so we
+ *              start one fewer worker threads than that.
+ */
+
+PERFT::PERFT(uint32_t cmbHash, int cthread) :
+    cthread(cthread > 0 ? cthread : max(1, (int)thread::hardware_concurrency()))
+{
+    cxperft = (uint64_t)cmbHash * 0x100000ULL / sizeof(XPERFT);
+    while (cxperft & (cxperft - 1))
+        cxperft &= cxperft - 1;
+    if (cxperft == 0)
+        cxperft = 1;
+    axperft = make_unique<XPERFT[]>(cxperft);
+
+    for (int ithread = 1; ithread < this->cthread; ithread++)
+        vthread.emplace_back(&PERFT::WorkerLoop, this);
+}
+
+/**
+ *  @fn         PERFT::~PERFT()
+ *  @brief      Shuts down the worker threads
+ */
+
+PERFT::~PERFT()
+{
+    {
+        lock_guard<mutex> lock(mtx);
+        fQuit = true;
+    }
+    cvStart.notify_all();
+    for (thread& th : vthread)
+        th.join();
+}
+
+/**
+ *  @fn         void PERFT::Clear(void)
+ *  @brief      Empties the transposition table
+ */
+
+void PERFT::Clear(void) noexcept
+{
+    for (uint64_t ixperft = 0; ixperft < cxperft; ixperft++) {
+        axperft[ixperft].haXor.store(0, memory_order_relaxed);
+        axperft[ixperft].grf.store(0, memory_order_relaxed);
+    }
+}
+
+/**
+ *  @fn         int64_t PERFT::CmvPerft(const BD& bd, int d)
+ *  @brief      Counts the leaf nodes of the legal move tree at depth d
+ *
+ *  @details    The root moves are split up among the threads. We post the
+ *              job to the worker threads, do our share of it, and wait for
+ *              the workers to finish theirs.
+ */
+
+int64_t PERFT::CmvPerft(const BD& bdRoot, int d)
+{
+    if (d <= 1 || vthread.empty()) {
+        BD bd(bdRoot);
+        return CmvPerftHash(bd, d);
+    }
+
+    VMV vmv;
+    bdRoot.MoveGen(vmv);
+    {
+        lock_guard<mutex> lock(mtx);
+        pbdJob = &bdRoot;
+        pvmvJob = &vmv;
+        dJob = d;
+        imvNext = 0;
+        cmvJob = 0;
+        cthreadBusy = (int)vthread.size();
+        ijob++;
+    }
+    cvStart.notify_all();
+    Work();
+
+    unique_lock<mutex> lock(mtx);
+    cvDone.wait(lock, [this] { return cthreadBusy == 0; });
+    return cmvJob;
+}
+
+/**
+ *  @fn         void PERFT::WorkerLoop(void)
+ *  @brief      The worker thread's main loop
+ *
+ *  @details    Sleeps until there's a new job or we're shutting down, 
+ *              works on the job, and tells CmvPerft when it's done.
+ */
+
+void PERFT::WorkerLoop(void)
+{
+    uint64_t ijobLast = 0;
+    while (true) {
+        {
+            unique_lock<mutex> lock(mtx);
+            cvStart.wait(lock, [&] { return fQuit || ijob != ijobLast; });
+            if (fQuit)
+                return;
+            ijobLast = ijob;
+        }
+        Work();
+        {
+            lock_guard<mutex> lock(mtx);
+            cthreadBusy--;
+        }
+        cvDone.notify_one();
+    }
+}
+
+/**
+ *  @fn         void PERFT::Work(void)
+ *  @brief      Does one thread's share of a CmvPerft job
+ *
+ *  @details    Each thread grabs the next unclaimed root move until they're
+ *              all gone.
+ */
+
+void PERFT::Work(void)
+{
+    BD bd(*pbdJob);
+    int64_t cmv = 0;
+    for (int imv; (imv = imvNext++) < (int)pvmvJob->size(); ) {
+        bd.MakeMv((*pvmvJob)[imv]);
+        cmv += CmvPerftHash(bd, dJob - 1);
+        bd.UndoMv();
+    }
+    cmvJob += cmv;
+}
+
+/**
+ *  @fn         int64_t PERFT::CmvPerftHash(BD& bd, int d)
+ *  @brief      The recursive perft worker
+ *
+ *  @details    The last ply just counts the legal moves without making them.
+ *              Everything above that is cached in the table. The depth is 
+ *              mixed into the table index so the same position at different
+ *              depths doesn't fight over one slot.
+ */
+
+int64_t PERFT::CmvPerftHash(BD& bd, int d) noexcept
+{
+    if (d == 0)
+        return 1;
+
+    VMV vmv;
+    bd.MoveGen(vmv);
+    if (d == 1)
+        return vmv.size();
+
+    XPERFT& xperft = (*this)[bd.ha ^ ((HA)d * 0x9e3779b97f4a7c15ULL)];
+    uint64_t grf = xperft.grf.load(memory_order_relaxed);
+    if ((xperft.haXor.load(memory_order_relaxed) ^ grf) == bd.ha && (grf & 0xff) == (uint64_t)d)
+        return (int64_t)(grf >> 8);
+
+    int64_t cmv = 0;
+    for (const MV& mv : vmv) {
+        bd.MakeMv(mv);
+        cmv += CmvPerftHash(bd, d - 1);
+        bd.UndoMv();
+    }
+
+    grf = ((uint64_t)cmv << 8) | (uint64_t)d;
+    xperft.haXor.store(bd.ha ^ grf, memory_order_relaxed);
+    xperft.grf.store(grf, memory_order_relaxed);
+    return cmv;
+}
+
+/**
+ *  The perft test suite. Shared by the test window in the desktop app and 
+ *  the perftbench command line tool.
+ * 
+ *  TODO: I bet these counts could be converted into an EPD parameter
+ */
+
+const PERFTTEST aperft[] = {
+
+    /*
+     *  perft tests from chessprogramming.org
+     */
+    
+    { "Initial", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        { 1, 20LL, 400LL, 8902LL, 197281LL, 4865609LL, 119060324LL, 3195901860LL, 
+          84998978956LL,2439530234167LL, 69352859712417LL, 2097651003696806LL, 
+          62854969236701747LL, 1981066775000396239LL } },
+    { "Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 
+        { 1, 48LL, 2039LL, 97862LL, 4085603LL, 193690690LL, 8031647685LL } },
+    { "Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 
+        { 1, 14LL, 191LL, 2812LL, 43238LL, 674624LL, 11030083LL, 178633661LL, 
+          3009794393LL } },
+    { "Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 
+        { 1, 6LL, 264LL, 9467LL, 422333LL, 15833292LL, 706045033LL } },
+    { "Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 
+        { 1, 44LL, 1486LL, 62379LL, 2103487LL, 89941194LL } },
+    { "Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        { 1, 46LL, 2079LL, 89890LL, 3894594LL, 164075551LL, 6923051137LL, 
+          287188994746LL, 11923589843526LL, 490154852788714LL } },
+    /*
+     *  perft test suite from algerbrex
+     *  https://github.com/algerbrex/blunder/blob/main/testdata/perftsuite.epd
+     */
+
+    { "Perftsuite 3", "4k3/8/8/8/8/8/8/4K2R w K - 0 1", { 1, 15LL, 66LL, 1197LL, 7059LL, 133987LL, 764643LL} },
+    { "Perftsuite 4", "4k3/8/8/8/8/8/8/R3K3 w Q - 0 1", { 1, 16LL, 71LL, 1287LL, 7626LL, 145232LL, 846648LL} },
+    { "Perftsuite 5", "4k2r/8/8/8/8/8/8/4K3 w k - 0 1", { 1, 5LL, 75LL, 459LL, 8290LL, 47635LL, 899442LL} },
+    { "Perftsuite 6", "r3k3/8/8/8/8/8/8/4K3 w q - 0 1", { 1, 5LL, 80LL, 493LL, 8897LL, 52710LL, 1001523LL} },
+    { "Perftsuite 7", "4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1", { 1, 26LL, 112LL, 3189LL, 17945LL, 532933LL, 2788982LL} },
+    { "Perftsuite 8", "r3k2r/8/8/8/8/8/8/4K3 w kq - 0 1", { 1, 5LL, 130LL, 782LL, 22180LL, 118882LL, 3517770LL} },
+    { "Perftsuite 9", "8/8/8/8/8/8/6k1/4K2R w K - 0 1", { 1, 12LL, 38LL, 564LL, 2219LL, 37735LL, 185867LL} },
+    { "Perftsuite 10", "8/8/8/8/8/8/1k6/R3K3 w Q - 0 1", { 1, 15LL, 65LL, 1018LL, 4573LL, 80619LL, 413018LL} },
+    { "Perftsuite 11", "4k2r/6K1/8/8/8/8/8/8 w k - 0 1", { 1, 3LL, 32LL, 134LL, 2073LL, 10485LL, 179869LL} },
+    { "Perftsuite 12", "r3k3/1K6/8/8/8/8/8/8 w q - 0 1", { 1, 4LL, 49LL, 243LL, 3991LL, 20780LL, 367724} },
+    { "Perftsuite 13", "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", { 1, 26LL, 568LL, 13744LL, 314346LL, 7594526LL, 179862938LL } },
+    { "Perftsuite 14", "r3k2r/8/8/8/8/8/8/1R2K2R w Kkq - 0 1", { 1, 25LL, 567LL, 14095LL, 328965LL, 8153719LL, 195629489LL } },
+    { "Perftsuite 15", "r3k2r/8/8/8/8/8/8/2R1K2R w Kkq - 0 1", { 1, 25LL, 548LL, 13502LL, 312835LL, 7736373LL, 184411439LL } },
+    { "Perftsuite 16", "r3k2r/8/8/8/8/8/8/R3K1R1 w Qkq - 0 1", { 1, 25LL, 547LL, 13579LL, 316214LL, 7878456LL, 189224276LL } },
+    { "Perftsuite 17", "1r2k2r/8/8/8/8/8/8/R3K2R w KQk - 0 1", { 1, 26LL, 583LL, 14252LL, 334705LL, 8198901LL, 198328929LL } },
+    { "Perftsuite 18", "2r1k2r/8/8/8/8/8/8/R3K2R w KQk - 0 1", { 1, 25LL, 560LL, 13592LL, 317324LL, 7710115LL, 185959088LL } },
+    { "Perftsuite 19", "r3k1r1/8/8/8/8/8/8/R3K2R w KQq - 0 1", { 1, 25LL, 560LL, 13607LL, 320792LL, 7848606LL, 190755813LL } },
+    { "Perftsuite 20", "4k3/8/8/8/8/8/8/4K2R b K - 0 1", { 1, 5LL, 75LL, 459LL, 8290LL, 47635LL, 899442LL} },
+    { "Perftsuite 21", "4k3/8/8/8/8/8/8/R3K3 b Q - 0 1", { 1, 5LL, 80LL, 493LL, 8897LL, 52710LL, 1001523LL} },
+    { "Perftsuite 22", "4k2r/8/8/8/8/8/8/4K3 b k - 0 1", { 1, 15LL, 66LL, 1197LL, 7059LL, 133987LL, 764643LL} },
+    { "Perftsuite 23", "r3k3/8/8/8/8/8/8/4K3 b q - 0 1", { 1, 16LL, 71LL, 1287LL, 7626LL, 145232LL, 846648LL} },
+    { "Perftsuite 24", "4k3/8/8/8/8/8/8/R3K2R b KQ - 0 1", { 1, 5LL, 130LL, 782LL, 22180LL, 118882LL, 3517770LL} },
+    { "Perftsuite 25", "r3k2r/8/8/8/8/8/8/4K3 b kq - 0 1", { 1, 26LL, 112LL, 3189LL, 17945LL, 532933LL, 2788982LL} },
+    { "Perftsuite 26", "8/8/8/8/8/8/6k1/4K2R b K - 0 1", { 1, 3LL, 32LL, 134LL, 2073LL, 10485LL, 179869LL} },
+    { "Perftsuite 27", "8/8/8/8/8/8/1k6/R3K3 b Q - 0 1", { 1, 4LL, 49LL, 243LL, 3991LL, 20780LL, 367724LL} },
+    { "Perftsuite 28", "4k2r/6K1/8/8/8/8/8/8 b k - 0 1", { 1, 12LL, 38LL, 564LL, 2219LL, 37735LL, 185867LL} },
+    { "Perftsuite 29", "r3k3/1K6/8/8/8/8/8/8 b q - 0 1", { 1, 15LL, 65LL, 1018LL, 4573LL, 80619LL, 413018LL} },
+    { "Perftsuite 30", "r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", { 1, 26LL, 568LL, 13744LL, 314346LL, 7594526LL, 179862938LL } },
+    { "Perftsuite 31", "r3k2r/8/8/8/8/8/8/1R2K2R b Kkq - 0 1", { 1, 26LL, 583LL, 14252LL, 334705LL, 8198901LL, 198328929LL } },
+    { "Perftsuite 32", "r3k2r/8/8/8/8/8/8/2R1K2R b Kkq - 0 1", { 1, 25LL, 560LL, 13592LL, 317324LL, 7710115LL, 185959088LL } },
+    { "Perftsuite 33", "r3k2r/8/8/8/8/8/8/R3K1R1 b Qkq - 0 1", { 1, 25LL, 560LL, 13607LL, 320792LL, 7848606LL, 190755813LL} },
+    { "Perftsuite 34", "1r2k2r/8/8/8/8/8/8/R3K2R b KQk - 0 1", { 1, 25LL, 567LL, 14095LL, 328965LL, 8153719LL, 195629489LL } },
+    { "Perftsuite 35", "2r1k2r/8/8/8/8/8/8/R3K2R b KQk - 0 1", { 1, 25LL, 548LL, 13502LL, 312835LL, 7736373LL, 184411439LL } },
+    { "Perftsuite 36", "r3k1r1/8/8/8/8/8/8/R3K2R b KQq - 0 1", { 1, 25LL, 547LL, 13579LL, 316214LL, 7878456LL, 189224276LL } },
+    { "Perftsuite 37", "8/1n4N1/2k5/8/8/5K2/1N4n1/8 w - - 0 1", { 1, 14LL, 195LL, 2760LL, 38675LL, 570726LL, 8107539LL} },
+    { "Perftsuite 38", "8/1k6/8/5N2/8/4n3/8/2K5 w - - 0 1", { 1, 11LL, 156LL, 1636LL, 20534LL, 223507LL, 2594412LL} },
+    { "Perftsuite 39", "8/8/4k3/3Nn3/3nN3/4K3/8/8 w - - 0 1", { 1, 19LL, 289LL, 4442LL, 73584LL, 1198299LL, 19870403LL} },
+    { "Perftsuite 40", "K7/8/2n5/1n6/8/8/8/k6N w - - 0 1", { 1, 3LL, 51LL, 345LL, 5301LL, 38348LL, 588695LL} },
+    { "Perftsuite 41", "k7/8/2N5/1N6/8/8/8/K6n w - - 0 1", { 1, 17LL, 54LL, 835LL, 5910LL, 92250LL, 688780LL} },
+    { "Perftsuite 42", "8/1n4N1/2k5/8/8/5K2/1N4n1/8 b - - 0 1", { 1, 15LL, 193LL, 2816LL, 40039LL, 582642LL, 8503277LL} },
+    { "Perftsuite 43", "8/1k6/8/5N2/8/4n3/8/2K5 b - - 0 1", { 1, 16LL, 180LL, 2290LL, 24640LL, 288141LL, 3147566LL} },
+    { "Perftsuite 44", "8/8/3K4/3Nn3/3nN3/4k3/8/8 b - - 0 1", { 1, 4LL, 68LL, 1118LL, 16199LL, 281190LL, 4405103LL} },
+    { "Perftsuite 45", "K7/8/2n5/1n6/8/8/8/k6N b - - 0 1", { 1, 17LL, 54LL, 835LL, 5910LL, 92250LL, 688780LL} },
+    { "Perftsuite 46", "k7/8/2N5/1N6/8/8/8/K6n b - - 0 1", { 1, 3LL, 51LL, 345LL, 5301LL, 38348LL, 588695LL} },
+    { "Perftsuite 47", "B6b/8/8/8/2K5/4k3/8/b6B w - - 0 1", { 1, 17LL, 278LL, 4607LL, 76778LL, 1320507LL, 22823890LL} },
+    { "Perftsuite 48", "8/8/1B6/7b/7k/8/2B1b3/7K w - - 0 1", { 1, 21LL, 316LL, 5744LL, 93338LL, 1713368LL, 28861171LL} },
+    { "Perftsuite 49", "k7/B7/1B6/1B6/8/8/8/K6b w - - 0 1", { 1, 21LL, 144LL, 3242LL, 32955LL, 787524LL, 7881673LL} },
+    { "Perftsuite 50", "K7/b7/1b6/1b6/8/8/8/k6B w - - 0 1", { 1, 7LL, 143LL, 1416LL, 31787LL, 310862LL, 7382896LL} },
+    { "Perftsuite 51", "B6b/8/8/8/2K5/5k2/8/b6B b - - 0 1", { 1, 6LL, 106LL, 1829LL, 31151LL, 530585LL, 9250746LL} },
+    { "Perftsuite 52", "8/8/1B6/7b/7k/8/2B1b3/7K b - - 0 1", { 1, 17LL, 309LL, 5133LL, 93603LL, 1591064LL, 29027891LL} },
+    { "Perftsuite 53", "k7/B7/1B6/1B6/8/8/8/K6b b - - 0 1", { 1, 7LL, 143LL, 1416LL, 31787LL, 310862LL, 7382896LL} },
+    { "Perftsuite 54", "K7/b7/1b6/1b6/8/8/8/k6B b - - 0 1", { 1, 21LL, 144LL, 3242LL, 32955LL, 787524LL, 7881673LL} },
+    { "Perftsuite 55", "7k/RR6/8/8/8/8/rr6/7K w - - 0 1", { 1, 19LL, 275LL, 5300LL, 104342LL, 2161211LL, 44956585LL} },
+    { "Perftsuite 56", "R6r/8/8/2K5/5k2/8/8/r6R w - - 0 1", { 1, 36LL, 1027LL, 29215LL, 771461LL, 20506480LL, 525169084LL} },
+    { "Perftsuite 57", "7k/RR6/8/8/8/8/rr6/7K b - - 0 1", { 1, 19LL, 275LL, 5300LL, 104342LL, 2161211LL, 44956585LL} },
+    { "Perftsuite 58", "R6r/8/8/2K5/5k2/8/8/r6R b - - 0 1", { 1, 36LL, 1027LL, 29227LL, 771368LL, 20521342LL, 524966748LL} },
+    { "Perftsuite 59", "6kq/8/8/8/8/8/8/7K w - - 0 1", { 1, 2LL, 36LL, 143LL, 3637LL, 14893LL, 391507LL} },
+    { "Perftsuite 60", "6KQ/8/8/8/8/8/8/7k b - - 0 1", { 1, 2LL, 36LL, 143LL, 3637LL, 14893LL, 391507LL} },
+    { "Perftsuite 61", "K7/8/8/3Q4/4q3/8/8/7k w - - 0 1", { 1, 6LL, 35LL, 495LL, 8349LL, 166741LL, 3370175LL} },
+    { "Perftsuite 62", "6qk/8/8/8/8/8/8/7K b - - 0 1", { 1, 22LL, 43LL, 1015LL, 4167LL, 105749LL, 419369LL} },
+    { "Perftsuite 63", "6KQ/8/8/8/8/8/8/7k b - - 0 1", { 1, 2LL, 36LL, 143LL, 3637LL, 14893LL, 391507LL} },
+    { "Perftsuite 64", "K7/8/8/3Q4/4q3/8/8/7k b - - 0 1", { 1, 6LL, 35LL, 495LL, 8349LL, 166741LL, 3370175LL} },
+    { "Perftsuite 65", "8/8/8/8/8/K7/P7/k7 w - - 0 1", { 1, 3LL, 7LL, 43LL, 199LL, 1347LL, 6249LL} },
+    { "Perftsuite 66", "8/8/8/8/8/7K/7P/7k w - - 0 1", { 1, 3LL, 7LL, 43LL, 199LL, 1347LL, 6249LL} },
+    { "Perftsuite 67", "K7/p7/k7/8/8/8/8/8 w - - 0 1", { 1, 1LL, 3LL, 12LL, 80LL, 342LL, 2343LL} },
+    { "Perftsuite 68", "7K/7p/7k/8/8/8/8/8 w - - 0 1", { 1, 1LL, 3LL, 12LL, 80LL, 342LL, 2343LL} },
+    { "Perftsuite 69", "8/2k1p3/3pP3/3P2K1/8/8/8/8 w - - 0 1", { 1, 7LL, 35LL, 210LL, 1091LL, 7028LL, 34834LL} },
+    { "Perftsuite 70", "8/8/8/8/8/K7/P7/k7 b - - 0 1", { 1, 1LL, 3LL, 12LL, 80LL, 342LL, 2343LL} },
+    { "Perftsuite 71", "8/8/8/8/8/7K/7P/7k b - - 0 1", { 1, 1LL, 3LL, 12LL, 80LL, 342LL, 2343LL} },
+    { "Perftsuite 72", "K7/p7/k7/8/8/8/8/8 b - - 0 1", { 1, 3LL, 7LL, 43LL, 199LL, 1347LL, 6249LL} },
+    { "Perftsuite 73", "7K/7p/7k/8/8/8/8/8 b - - 0 1", { 1, 3LL, 7LL, 43LL, 199LL, 1347LL, 6249LL} },
+    { "Perftsuite 74", "8/2k1p3/3pP3/3P2K1/8/8/8/8 b - - 0 1", { 1, 5LL, 35LL, 182LL, 1091LL, 5408LL, 34822LL} },
+    { "Perftsuite 75", "8/8/8/8/8/4k3/4P3/4K3 w - - 0 1", { 1, 2LL, 8LL, 44LL, 282LL, 1814LL, 11848LL} },
+    { "Perftsuite 76", "4k3/4p3/4K3/8/8/8/8/8 b - - 0 1", { 1, 2LL, 8LL, 44LL, 282LL, 1814LL, 11848LL} },
+    { "Perftsuite 77", "8/8/7k/7p/7P/7K/8/8 w - - 0 1", { 1, 3LL, 9LL, 57LL, 360LL, 1969LL, 10724LL} },
+    { "Perftsuite 78", "8/8/k7/p7/P7/K7/8/8 w - - 0 1", { 1, 3LL, 9LL, 57LL, 360LL, 1969LL, 10724LL} },
+    { "Perftsuite 79", "8/8/3k4/3p4/3P4/3K4/8/8 w - - 0 1", { 1, 5LL, 25LL, 180LL, 1294LL, 8296LL, 53138LL} },
+    { "Perftsuite 80", "8/3k4/3p4/8/3P4/3K4/8/8 w - - 0 1", { 1, 8LL, 61LL, 483LL, 3213LL, 23599LL, 157093LL} },
+    { "Perftsuite 81", "8/8/3k4/3p4/8/3P4/3K4/8 w - - 0 1", { 1, 8LL, 61LL, 411LL, 3213LL, 21637LL, 158065LL} },
+    { "Perftsuite 82", "k7/8/3p4/8/3P4/8/8/7K w - - 0 1", { 1, 4LL, 15LL, 90LL, 534LL, 3450LL, 20960LL} },
+    { "Perftsuite 83", "8/8/7k/7p/7P/7K/8/8 b - - 0 1", { 1, 3LL, 9LL, 57LL, 360LL, 1969LL, 10724LL} },
+    { "Perftsuite 84", "8/8/k7/p7/P7/K7/8/8 b - - 0 1", { 1, 3LL, 9LL, 57LL, 360LL, 1969LL, 10724LL} },
+    { "Perftsuite 85", "8/8/3k4/3p4/3P4/3K4/8/8 b - - 0 1", { 1, 5LL, 25LL, 180LL, 1294LL, 8296LL, 53138LL} },
+    { "Perftsuite 86", "8/3k4/3p4/8/3P4/3K4/8/8 b - - 0 1", { 1, 8LL, 61LL, 411LL, 3213LL, 21637LL, 158065LL} },
+    { "Perftsuite 87", "8/8/3k4/3p4/8/3P4/3K4/8 b - - 0 1", { 1, 8LL, 61LL, 483LL, 3213LL, 23599LL, 157093LL} },
+    { "Perftsuite 88", "k7/8/3p4/8/3P4/8/8/7K b - - 0 1", { 1, 4LL, 15LL, 89LL, 537LL, 3309LL, 21104LL} },
+    { "Perftsuite 89", "7k/3p4/8/8/3P4/8/8/K7 w - - 0 1", { 1, 4LL, 19LL, 117LL, 720LL, 4661LL, 32191LL} },
+    { "Perftsuite 90", "7k/8/8/3p4/8/8/3P4/K7 w - - 0 1", { 1, 5LL, 19LL, 116LL, 716LL, 4786LL, 30980LL} },
+    { "Perftsuite 91", "k7/8/8/7p/6P1/8/8/K7 w - - 0 1", { 1, 5LL, 22LL, 139LL, 877LL, 6112LL, 41874LL} },
+    { "Perftsuite 92", "k7/8/7p/8/8/6P1/8/K7 w - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4354LL, 29679LL} },
+    { "Perftsuite 93", "k7/8/8/6p1/7P/8/8/K7 w - - 0 1", { 1, 5LL, 22LL, 139LL, 877LL, 6112LL, 41874LL} },
+    { "Perftsuite 94", "k7/8/6p1/8/8/7P/8/K7 w - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4354LL, 29679LL} },
+    { "Perftsuite 95", "k7/8/8/3p4/4p3/8/8/7K w - - 0 1", { 1, 3LL, 15LL, 84LL, 573LL, 3013LL, 22886LL} },
+    { "Perftsuite 96", "k7/8/3p4/8/8/4P3/8/7K w - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4271LL, 28662LL} },
+    { "Perftsuite 97", "7k/3p4/8/8/3P4/8/8/K7 b - - 0 1", { 1, 5LL, 19LL, 117LL, 720LL, 5014LL, 32167LL} },
+    { "Perftsuite 98", "7k/8/8/3p4/8/8/3P4/K7 b - - 0 1", { 1, 4LL, 19LL, 117LL, 712LL, 4658LL, 30749LL} },
+    { "Perftsuite 99", "k7/8/8/7p/6P1/8/8/K7 b - - 0 1", { 1, 5LL, 22LL, 139LL, 877LL, 6112LL, 41874LL} },
+    { "Perftsuite 100", "k7/8/7p/8/8/6P1/8/K7 b - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4354LL, 29679LL} },
+    { "Perftsuite 101", "k7/8/8/6p1/7P/8/8/K7 b - - 0 1", { 1, 5LL, 22LL, 139LL, 877LL, 6112LL, 41874LL} },
+    { "Perftsuite 102", "k7/8/6p1/8/8/7P/8/K7 b - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4354LL, 29679LL} },
+    { "Perftsuite 103", "k7/8/8/3p4/4p3/8/8/7K b - - 0 1", { 1, 5LL, 15LL, 102LL, 569LL, 4337LL, 22579LL} },
+    { "Perftsuite 104", "k7/8/3p4/8/8/4P3/8/7K b - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4271LL, 28662LL} },
+    { "Perftsuite 105", "7k/8/8/p7/1P6/8/8/7K w - - 0 1", { 1, 5LL, 22LL, 139LL, 877LL, 6112LL, 41874LL} },
+    { "Perftsuite 106", "7k/8/p7/8/8/1P6/8/7K w - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4354LL, 29679LL} },
+    { "Perftsuite 107", "7k/8/8/1p6/P7/8/8/7K w - - 0 1", { 1, 5LL, 22LL, 139LL, 877LL, 6112LL, 41874LL} },
+    { "Perftsuite 108", "7k/8/1p6/8/8/P7/8/7K w - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4354LL, 29679LL} },
+    { "Perftsuite 109", "k7/7p/8/8/8/8/6P1/K7 w - - 0 1", { 1, 5LL, 25LL, 161LL, 1035LL, 7574LL, 55338LL} },
+    { "Perftsuite 110", "k7/6p1/8/8/8/8/7P/K7 w - - 0 1", { 1, 5LL, 25LL, 161LL, 1035LL, 7574LL, 55338LL} },
+    { "Perftsuite 111", "3k4/3pp3/8/8/8/8/3PP3/3K4 w - - 0 1", { 1, 7LL, 49LL, 378LL, 2902LL, 24122LL, 199002LL} },
+    { "Perftsuite 112", "7k/8/8/p7/1P6/8/8/7K b - - 0 1", { 1, 5LL, 22LL, 139LL, 877LL, 6112LL, 41874LL} },
+    { "Perftsuite 113", "7k/8/p7/8/8/1P6/8/7K b - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4354LL, 29679LL} },
+    { "Perftsuite 114", "7k/8/8/1p6/P7/8/8/7K b - - 0 1", { 1, 5LL, 22LL, 139LL, 877LL, 6112LL, 41874LL} },
+    { "Perftsuite 115", "7k/8/1p6/8/8/P7/8/7K b - - 0 1", { 1, 4LL, 16LL, 101LL, 637LL, 4354LL, 29679LL} },
+    { "Perftsuite 116", "k7/7p/8/8/8/8/6P1/K7 b - - 0 1", { 1, 5LL, 25LL, 161LL, 1035LL, 7574LL, 55338LL} },
+    { "Perftsuite 117", "k7/6p1/8/8/8/8/7P/K7 b - - 0 1", { 1, 5LL, 25LL, 161LL, 1035LL, 7574LL, 55338LL} },
+    { "Perftsuite 118", "3k4/3pp3/8/8/8/8/3PP3/3K4 b - - 0 1", { 1, 7LL, 49LL, 378LL, 2902LL, 24122LL, 199002LL} },
+    { "Perftsuite 119", "8/Pk6/8/8/8/8/6Kp/8 w - - 0 1", { 1, 11LL, 97LL, 887LL, 8048LL, 90606LL, 1030499LL} },
+    { "Perftsuite 120", "n1n5/1Pk5/8/8/8/8/5Kp1/5N1N w - - 0 1", { 1, 24LL, 421LL, 7421LL, 124608LL, 2193768LL, 37665329LL} },
+    { "Perftsuite 121", "8/PPPk4/8/8/8/8/4Kppp/8 w - - 0 1", { 1, 18LL, 270LL, 4699LL, 79355LL, 1533145LL, 28859283LL} },
+    { "Perftsuite 122", "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N w - - 0 1", { 1, 24LL, 496LL, 9483LL, 182838LL, 3605103LL, 71179139LL} },
+    { "Perftsuite 123", "8/Pk6/8/8/8/8/6Kp/8 b - - 0 1", { 1, 11LL, 97LL, 887LL, 8048LL, 90606LL, 1030499LL} },
+    { "Perftsuite 124", "n1n5/1Pk5/8/8/8/8/5Kp1/5N1N b - - 0 1", { 1, 24LL, 421LL, 7421LL, 124608LL, 2193768LL, 37665329LL} },
+    { "Perftsuite 125", "8/PPPk4/8/8/8/8/4Kppp/8 b - - 0 1", { 1, 18LL, 270LL, 4699LL, 79355LL, 1533145LL, 28859283LL} },
+    { "Perftsuite 126", "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", { 1, 24LL, 496LL, 9483LL, 182838LL, 3605103LL, 71179139LL} },
+ 
+    { "Perftsuite 127", "8/8/1k6/8/2pP4/8/5BK1/8 b - d3 0 1", { 1, -1, -1, -1, -1, -1, 824064LL} },
+    { "Perftsuite 128", "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", { 1, -1, -1, -1, -1, -1, 1440467LL} },
+    { "Perftsuite 129", "8/5k2/8/2Pp4/2B5/1K6/8/8 w - d6 0 1", { 1, -1, -1, -1, -1, -1, 1440467LL} },
+    { "Perftsuite 130", "5k2/8/8/8/8/8/8/4K2R w K - 0 1", { 1, -1, -1, -1, -1, -1, 661072LL} },
+    { "Perftsuite 131", "4k2r/8/8/8/8/8/8/5K2 b k - 0 1", { 1, -1, -1, -1, -1, -1, 661072LL} },
+    { "Perftsuite 132", "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", { 1, -1, -1, -1, -1, -1, 803711LL} },
+    { "Perftsuite 133", "r3k3/8/8/8/8/8/8/3K4 b q - 0 1", { 1, -1, -1, -1, -1, -1, 803711LL} },
+    { "Perftsuite 134", "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", { 1, -1, -1, -1, 1274206LL} },
+    { "Perftsuite 135", "r3k2r/7b/8/8/8/8/1B4BQ/R3K2R b KQkq - 0 1", { 1, -1, -1, -1, 1274206LL} },
+    { "Perftsuite 136", "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", { 1, -1, -1, -1, 1720476LL} },
+    { "Perftsuite 137", "r3k2r/8/5Q2/8/8/3q4/8/R3K2R w KQkq - 0 1", { 1, -1, -1, -1, 1720476LL} },
+    { "Perftsuite 138", "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", { 1, -1, -1, -1, -1, -1, 3821001LL} },
+    { "Perftsuite 139", "3K4/8/8/8/8/8/4p3/2k2R2 b - - 0 1", { 1, -1, -1, -1, -1, -1, 3821001LL} },
+    { "Perftsuite 140", "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", { 1, -1, -1, -1, -1, 1004658LL} },
+    { "Perftsuite 141", "5K2/8/1Q6/2N5/8/1p2k3/8/8 w - - 0 1", { 1, -1, -1, -1, -1, 1004658LL} },
+    { "Perftsuite 142", "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", { 1, -1, -1, -1, -1, -1, 217342LL} },
+    { "Perftsuite 143", "8/k7/8/8/8/8/1p6/4K3 b - - 0 1", { 1, -1, -1, -1, -1, -1, 217342LL} },
+    { "Perftsuite 144", "8/P1k5/K7/8/8/8/8/8 w - - 0 1", { 1, -1, -1, -1, -1, -1, 92683LL} },
+    { "Perftsuite 145", "8/8/8/8/8/k7/p1K5/8 b - - 0 1", { 1, -1, -1, -1, -1, -1, 92683LL} },
+    { "Perftsuite 146", "K1k5/8/P7/8/8/8/8/8 w - - 0 1", { 1, -1, -1, -1, -1, -1, 2217LL} },
+    { "Perftsuite 147", "8/8/8/8/8/p7/8/k1K5 b - - 0 1", { 1, -1, -1, -1, -1, -1, 2217LL} },
+    { "Perftsuite 148", "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", { 1, -1, -1, -1, -1, -1, -1, 567584LL} },
+    { "Perftsuite 149", "8/8/8/8/1k6/8/K1p5/8 b - - 0 1", { 1, -1, -1, -1, -1, -1, -1, 567584LL} },
+    { "Perftsuite 150", "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", { 1, -1, -1, -1, 23527LL} },
+    { "Perftsuite 151", "8/5k2/8/5N2/5Q2/2K5/8/8 w - - 0 1", { 1, -1, -1, -1, 23527LL} },
+    { "Perftsuite 152", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", { 1, -1, -1, -1, -1, 193690690LL} },
+    { "Perftsuite 153", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 1, -1, -1, -1, -1, -1, 11030083LL} },
+    { "Perftsuite 154", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", { 1, -1, -1, -1, -1, 15833292LL} },
+    { "Perftsuite 155", "rnbqkb1r/pp1p1ppp/2p5/4P3/2B5/8/PPP1NnPP/RNBQK2R w KQkq - 0 1", { 1, -1, -1, 53392LL} },
+    { "Perftsuite 156", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 1", { 1, -1, -1, -1, -1, 164075551LL} },
+    { "Perftsuite 157", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", { 1, -1, -1, -1, -1, -1, -1, 178633661LL} },
+    { "Perftsuite 158", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", {1, -1, -1, -1, -1, -1, 706045033LL} },
+    { "Perftsuite 159", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", { 1, -1, -1, -1, -1, 89941194LL} },
+    { "Perftsuite 160", "1k6/1b6/8/8/7R/8/8/4K2R b K - 0 1", { 1, -1, -1, -1, -1, 1063513LL} },
+    { "Perftsuite 161", "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", { 1, -1, -1, -1, -1, -1, 1134888LL} },
+    { "Perftsuite 162", "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", { 1, -1, -1, -1, -1, -1, 1015133LL} }
+};
+
+const int cperft = (int)size(aperft);
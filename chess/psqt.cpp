@@ -6,23 +6,8 @@
  */
 
 #include "chess.h"
+#include "psqt.h"
 
-/*
- *  InitPsqt
- *  
- *  Initializes the piece square table from the raw talbes
- */
-
-void InitPsqt(EV mpcptev[cptMax], EV mpcptsqdev[cptMax][sqMax], EV mpcpsqev[cpMax][sqMax]) noexcept
-{
-    memset(mpcpsqev, 0, sizeof(EV) * cpMax * sqMax);
-    for (CPT cpt = cptPawn; cpt < cptMax; ++cpt) {
-        for (SQ sq = 0; sq < sqMax; ++sq) {
-            mpcpsqev[Cp(cpcWhite, cpt)][sq] = mpcptev[cpt] + mpcptsqdev[cpt][SqFlip(sq)];
-            mpcpsqev[Cp(cpcBlack, cpt)][sq] = mpcptev[cpt] + mpcptsqdev[cpt][sq];
-        }
-    }
-}
 /*
  *  EvInterpolate
  *
@@ -40,8 +25,8 @@ EV EvInterpolate(int phaseCur, EV evFirst, int phaseFirst, EV evLim, int phaseLi
  *  middle game
  */
 
-EV mpcptevMid[cptMax] = { 0, 82, 337, 365, 477, 1025,  0 };
-EV mpcptsqdevMid[cptMax][sqMax] = {
+constexpr EV mpcptevMid[cptMax] = { 0, 82, 337, 365, 477, 1025,  0 };
+constexpr EV mpcptsqdevMid[cptMax][sqMax] = {
     { 0 },
     {   // pawns
       0,   0,   0,   0,   0,   0,  0,   0,
@@ -109,8 +94,8 @@ EV mpcptsqdevMid[cptMax][sqMax] = {
  *  end game
  */
 
-EV mpcptevEnd[cptMax] = { 0, 94, 281, 297, 512,  936,  0 };
-EV mpcptsqdevEnd[cptMax][sqMax] = {
+constexpr EV mpcptevEnd[cptMax] = { 0, 94, 281, 297, 512,  936,  0 };
+constexpr EV mpcptsqdevEnd[cptMax][sqMax] = {
     { 0 },
     {   // pawns
       0,   0,   0,   0,   0,   0,   0,   0,
@@ -174,3 +159,23 @@ EV mpcptsqdevEnd[cptMax][sqMax] = {
     }
 };
 
+
+/*
+ *  The combined piece value and square table, indexed by colored piece. The
+ *  board keeps running totals of these as pieces move. It's built from the 
+ *  raw tables at compile time, so there's nothing to set up at startup and
+ *  every engine in the process shares the one read-only copy.
+ */
+
+constinit const array<array<EVP, sqMax>, cpMax> mpcpsqevp = []() {
+    array<array<EVP, sqMax>, cpMax> mpcpsqevp = {};
+    for (CPT cpt = cptPawn; cpt < cptMax; ++cpt) {
+        for (SQ sq = 0; sq < sqMax; ++sq) {
+            mpcpsqevp[Cp(cpcWhite, cpt)][sq] = EVP(mpcptevMid[cpt] + mpcptsqdevMid[cpt][SqFlip(sq)],
+                                                   mpcptevEnd[cpt] + mpcptsqdevEnd[cpt][SqFlip(sq)]);
+            mpcpsqevp[Cp(cpcBlack, cpt)][sq] = EVP(mpcptevMid[cpt] + mpcptsqdevMid[cpt][sq],
+                                                   mpcptevEnd[cpt] + mpcptsqdevEnd[cpt][sq]);
+        }
+    }
+    return mpcpsqevp;
+}();
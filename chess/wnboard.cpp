@@ -329,11 +329,11 @@ void WNBOARD::DrawLastMove(void)
 {
     if (bd.vmvuGame.empty())
         return;
-    MVU& mvuLast = bd.vmvuGame.back();
+    const MVU& mvuLast = bd.vmvuGame.back();
     if (mvuLast.fIsNil())
         return;
-    DrawLastMoveOutline(mvuLast.sqFrom);
-    DrawLastMoveOutline(mvuLast.sqTo);
+    DrawLastMoveOutline(mvuLast.sqFrom());
+    DrawLastMoveOutline(mvuLast.sqTo());
 }
 
 /*
@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ *  @file       uci.h
+ *  @brief      UCI console chess engine
+ *
+ *  @details    A headless front end to the chess AI that speaks the
+ *              Universal Chess Interface protocol over stdin/stdout, so the
+ *              engine can be driven by tournament managers and other chess
+ *              GUIs.
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "chess.h"
+#include "computer.h"
+#include <mutex>
+
+/**
+ *  @class UCI
+ *  @brief The UCI engine
+ *
+ *  Reads UCI commands from an input stream and writes responses to an output
+ *  stream. Searches run on a separate thread so we can keep processing
+ *  commands, like stop and isready, while the AI is thinking.
+ */
+
+class UCI : public AI
+{
+public:
+    UCI(istream& is, ostream& os, const SETAI& set = setaiDefault);
+    ~UCI();
+
+    int Run(void);
+    bool FExecute(const string& sLine);
+
+    /* individual commands */
+
+    void Uci(void);
+    void Debug(istream& is);
+    void IsReady(void);
+    void SetOption(istream& is);
+    void UciNewGame(void);
+    void Position(istream& is);
+    void Go(istream& is);
+    void Stop(void);
+
+    /* search */
+
+    virtual void ReportDepth(BD& bd, int d, const MV& mvBest) noexcept override;
+
+private:
+    void StartSearch(const TMAN& tman);
+    void WaitSearch(void);
+    void SearchThread(const TMAN& tman);
+    MV MvParseUci(const string& s) const;
+    void Send(const string& s);
+
+private:
+    istream& is;
+    ostream& os;
+    mutex mtxOut;
+
+    BD bd;
+    thread threadSearch;
+    atomic<bool> fInfinite = false;   // wait for stop before reporting bestmove
+};
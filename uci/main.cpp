@@ -0,0 +1,16 @@
+/**
+ *  @file       main.cpp
+ *  @brief      UCI console chess engine entry point
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "uci.h"
+
+int main(int argc, char* argv[])
+{
+    ios::sync_with_stdio(false);
+    UCI uci(cin, cout);
+    return uci.Run();
+}
@@ -0,0 +1,347 @@
+/**
+ *  @file       uci.cpp
+ *  @brief      UCI console chess engine
+ *
+ *  @details    Implements the engine side of the Universal Chess Interface.
+ *              We support the subset of the protocol that tournament
+ *              managers actually use: uci, debug, isready, setoption,
+ *              ucinewgame, position, go, stop, and quit.
+ *
+ *              https://backscattering.de/chess/uci/
+ *
+ *  @author     Richard Powell
+ *  @copyright  Copyright (c) 2025 by Richard Powell
+ */
+
+#include "uci.h"
+
+UCI::UCI(istream& is, ostream& os, const SETAI& set) :
+    AI(set),
+    is(is),
+    os(os),
+    bd(fenStartPos)
+{
+}
+
+UCI::~UCI()
+{
+    fInterruptSearch = true;
+    WaitSearch();
+}
+
+/**
+ *  @fn         int UCI::Run(void)
+ *  @brief      The main command loop
+ *
+ *  @details    Reads and executes commands until we get a quit command or
+ *              the input stream is closed.
+ */
+
+int UCI::Run(void)
+{
+    string sLine;
+    while (getline(is, sLine)) {
+        if (!FExecute(sLine))
+            break;
+    }
+    fInterruptSearch = true;
+    WaitSearch();
+    return 0;
+}
+
+/**
+ *  @fn         bool UCI::FExecute(const string& sLine)
+ *  @brief      Executes a single line of UCI input.
+ *
+ *  @returns    false if the engine should quit.
+ */
+
+bool UCI::FExecute(const string& sLine)
+{
+    istringstream isLine(sLine);
+    string sCmd;
+    if (!(isLine >> sCmd))
+        return true;
+
+    try {
+        if (sCmd == "uci")
+            Uci();
+        else if (sCmd == "debug")
+            Debug(isLine);
+        else if (sCmd == "isready")
+            IsReady();
+        else if (sCmd == "setoption")
+            SetOption(isLine);
+        else if (sCmd == "ucinewgame")
+            UciNewGame();
+        else if (sCmd == "position")
+            Position(isLine);
+        else if (sCmd == "go")
+            Go(isLine);
+        else if (sCmd == "stop")
+            Stop();
+        else if (sCmd == "quit")
+            return false;
+        else
+            Send("info string unknown command " + sCmd);
+    }
+    catch (const ERR& err) {
+        Send("info string error " + to_string((HRESULT)err) + " in " + sLine);
+    }
+
+    return true;
+}
+
+void UCI::Uci(void)
+{
+    Send("id name WAPP Chess");
+    Send("id author Richard Powell");
+    Send("option name Hash type spin default " + to_string(set.cmbXt) + " min 1 max 4096");
+    Send("uciok");
+}
+
+/**
+ *  @fn         void UCI::Debug(istream& is)
+ *  @brief      Turns the search log on or off
+ *
+ *  @details    The search log goes to stderr so it doesn't interfere with the
+ *              protocol on stdout.
+ */
+
+void UCI::Debug(istream& is)
+{
+    string s;
+    is >> s;
+    logcon.SetOutput(s == "on" ? &cerr : nullptr);
+}
+
+void UCI::IsReady(void)
+{
+    Send("readyok");
+}
+
+/**
+ *  @fn         void UCI::SetOption(istream& is)
+ *  @brief      setoption name <id> [value <x>]
+ */
+
+void UCI::SetOption(istream& is)
+{
+    string s, sName, sValue;
+    is >> s;
+    if (s != "name")
+        return;
+    while (is >> s && s != "value")
+        sName += (sName.empty() ? "" : " ") + s;
+    while (is >> s)
+        sValue += (sValue.empty() ? "" : " ") + s;
+
+    if (sName == "Hash") {
+        WaitSearch();
+        set.cmbXt = clamp(atoi(sValue.c_str()), 1, 4096);
+        xt.SetSize(set.cmbXt);
+    }
+}
+
+void UCI::UciNewGame(void)
+{
+    WaitSearch();
+    bd.InitFromFen(fenStartPos);
+}
+
+/**
+ *  @fn         void UCI::Position(istream& is)
+ *  @brief      position [fen <fenstring> | startpos] moves <move1> ... <movei>
+ */
+
+void UCI::Position(istream& is)
+{
+    WaitSearch();
+
+    string s;
+    is >> s;
+    if (s == "startpos") {
+        bd.InitFromFen(fenStartPos);
+        is >> s;
+    }
+    else if (s == "fen") {
+        string fen;
+        while (is >> s && s != "moves")
+            fen += (fen.empty() ? "" : " ") + s;
+        bd.InitFromFen(fen);
+    }
+    else
+        return;
+
+    if (s != "moves")
+        return;
+    while (is >> s) {
+        MV mv = MvParseUci(s);
+        if (mv.fIsNil()) {
+            Send("info string illegal move " + s);
+            return;
+        }
+        bd.MakeMv(mv);
+    }
+}
+
+/**
+ *  @fn         void UCI::Go(istream& is)
+ *  @brief      Starts searching the current position
+ *
+ *  @details    All the go options map directly onto the time management
+ *              settings. We don't support pondering or searchmoves.
+ */
+
+void UCI::Go(istream& is)
+{
+    WaitSearch();
+
+    TMAN tman;
+    string s;
+    int64_t w;
+    fInfinite = false;
+    while (is >> s) {
+        if (s == "infinite")
+            fInfinite = true;
+        else if (s == "ponder")
+            continue;
+        else if (!(is >> w))
+            break;
+        else if (s == "wtime")
+            tman.mpcpcodtp[cpcWhite] = milliseconds(w);
+        else if (s == "btime")
+            tman.mpcpcodtp[cpcBlack] = milliseconds(w);
+        else if (s == "winc")
+            tman.mpcpcodtpInc[cpcWhite] = milliseconds(w);
+        else if (s == "binc")
+            tman.mpcpcodtpInc[cpcBlack] = milliseconds(w);
+        else if (s == "movestogo")
+            tman.ocmvExpire = max((int)w, 1);
+        else if (s == "depth")
+            tman.odMax = clamp((int)w, 1, dMax - 1);
+        else if (s == "nodes")
+            tman.ocmvSearch = (uint64_t)w;
+        else if (s == "mate")
+            tman.odMate = max((int)w, 1);
+        else if (s == "movetime")
+            tman.odtpTotal = milliseconds(w);
+    }
+
+    StartSearch(tman);
+}
+
+void UCI::Stop(void)
+{
+    fStopSearch = true;
+    WaitSearch();
+}
+
+/**
+ *  @fn         void UCI::StartSearch(const TMAN& tman)
+ *  @brief      Kicks off the search thread
+ */
+
+void UCI::StartSearch(const TMAN& tman)
+{
+    fStopSearch = false;
+    fInterruptSearch = false;
+    threadSearch = thread(&UCI::SearchThread, this, tman);
+}
+
+void UCI::WaitSearch(void)
+{
+    if (!threadSearch.joinable())
+        return;
+    fStopSearch = true;
+    threadSearch.join();
+}
+
+/**
+ *  @fn         void UCI::SearchThread(const TMAN& tman)
+ *  @brief      Searches a copy of the current board and reports the best move
+ *
+ *  @details    In infinite mode, the protocol does not let us report our
+ *              best move until we get a stop, even if the search finished
+ *              early, so we wait around for it.
+ */
+
+void UCI::SearchThread(const TMAN& tman)
+{
+    BD bdSearch(bd);
+    VMV vmv;
+    bdSearch.MoveGen(vmv);
+
+    MV mv;
+    if (vmv.size() > 0)
+        mv = MvBest(bdSearch, tman);
+
+    while (fInfinite && !fStopSearch && !fInterruptSearch)
+        this_thread::sleep_for(1ms);
+    fInfinite = false;
+
+    Send("bestmove " + (mv.fIsNil() ? string("0000") : to_string(mv)));
+}
+
+/**
+ *  @fn         void UCI::ReportDepth(BD& bd, int d, const MV& mvBest)
+ *  @brief      Sends the search info at the end of each depth iteration
+ * 
+ *  @details    The principal variation can end in a move that came from
+ *              the transposition table, so we play it out on a copy of the 
+ *              board and stop at anything that isn't legal.
+ */
+
+void UCI::ReportDepth(BD& bd, int d, const MV& mvBest) noexcept
+{
+    int64_t cmv = stat.cmvSearch + stat.cmvQuiescent;
+    int64_t ms = duration_cast<milliseconds>(TpNow() - tpSearchStart).count();
+    string sScore;
+    if (FEvIsMate(mvBest.ev))
+        sScore = "mate " + to_string((DFromEvMate(mvBest.ev) + 1) / 2);
+    else if (FEvIsMate(-mvBest.ev))
+        sScore = "mate " + to_string(-(DFromEvMate(-mvBest.ev) + 1) / 2);
+    else
+        sScore = "cp " + to_string((int)mvBest.ev);
+
+    string sPv = to_string(mvBest);
+    BD bdPv(bd);
+    bdPv.MakeMv(mvBest);
+    for (int imv = 1; imv < pvBestAll.size(); imv++) {
+        MV mv(pvBestAll[imv]);
+        if (!bdPv.FMvIsLegal(mv))
+            break;
+        sPv += " " + to_string(mv);
+        bdPv.MakeMv(mv);
+    }
+
+    Send("info depth " + to_string(d) +
+         " score " + sScore +
+         " nodes " + to_string(cmv) +
+         " nps " + to_string(cmv * 1000 / max(ms, (int64_t)1)) +
+         " time " + to_string(ms) +
+         " pv " + sPv);
+}
+
+/**
+ *  @fn         MV UCI::MvParseUci(const string& s) const
+ *  @brief      Finds the legal move that matches the UCI long algebraic move.
+ *
+ *  @returns    A nil move if the move isn't legal in the current position.
+ */
+
+MV UCI::MvParseUci(const string& s) const
+{
+    VMV vmv;
+    bd.MoveGen(vmv);
+    for (const MV& mv : vmv)
+        if (to_string(mv) == s)
+            return mv;
+    return MV();
+}
+
+void UCI::Send(const string& s)
+{
+    lock_guard<mutex> lock(mtxOut);
+    os << s << endl;
+}
@@ -81,6 +81,8 @@ public:
     }
 };
 
+#ifdef _WIN32
+
 /*
  *  ERRLAST
  *  
@@ -95,6 +97,8 @@ public:
     }
 };
 
+#endif // _WIN32
+
 /*
  *  A few standard commonly used errors
  */
@@ -17,6 +17,8 @@
 
 /* Core Windows */
 
+#ifdef _WIN32
+
 #define WIN32_LEAN_AND_MEAN
 #pragma warning(push, 0)
 #include <windows.h>
@@ -40,15 +42,23 @@
 #include <d2d1effecthelpers.h>
 #pragma warning(pop)
 
+#endif // _WIN32
+
 /* C standard library */
 
 #include <stdlib.h>
-#include <malloc.h>
+#include <stdint.h>
 #include <memory.h>
+#include <math.h>
+#ifdef _WIN32
+#include <malloc.h>
 #include <tchar.h>
 //#include <assert.h>
 #include <crtdbg.h>
 #define assert(f) _ASSERTE(f)
+#else
+#include <assert.h>
+#endif
 
 /* C++ standard library */
 
@@ -68,6 +78,7 @@
 #include <numbers>
 #include <random>
 #include <thread>
+#include <atomic>
 #include <chrono>
 #include <sstream>
 #include <iostream>
@@ -75,15 +86,48 @@
 #include <filesystem>
 #include <locale>
 #include <codecvt>
+#include <optional>
+#include <charconv>
+#include <concepts>
+#include <iomanip>
+#include <version>
+#ifdef __cpp_lib_format
+#include <format>
+#endif
 
 using namespace std;
-using namespace D2D1;
-using namespace Microsoft::WRL;
 using namespace std::chrono;
 using namespace std::chrono_literals;
 
+#ifdef _WIN32
+
+using namespace D2D1;
+using namespace Microsoft::WRL;
+
 template <typename T>
 using com_ptr = ComPtr<T>;
 
+#else
+
+/*
+ *  Minimal stand-ins for the handful of Windows types and macros that leak
+ *  into the portable console engine code. Only available in headless builds
+ *  on non-Windows platforms.
+ */
+
+typedef int32_t HRESULT;
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define MAKE_HRESULT(sev, fac, code) \
+    ((HRESULT)(((uint32_t)(sev) << 31) | ((uint32_t)(fac) << 16) | ((uint32_t)(code))))
+#define HRESULT_FACILITY(hr) (((hr) >> 16) & 0x1fff)
+#define HRESULT_CODE(hr) ((hr) & 0xffff)
+
+inline void DebugBreak(void) 
+{
+}
+
+#endif // _WIN32
+
 typedef time_point<high_resolution_clock> TP;
 typedef time_point<system_clock> TPS;
\ No newline at end of file
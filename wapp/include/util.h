@@ -128,6 +128,8 @@ private:
  *              We do not support floating point.
  */
 
+#ifdef __cpp_lib_format
+
 string SVFormat(string_view fmt, format_args args);
 
 template<typename... Args>
@@ -136,6 +138,8 @@ string SFormat(string_view fmt, Args&&... args)
     return SVFormat(fmt, make_format_args(args...));
 }
 
+#endif // __cpp_lib_format
+
 string SEscapeQuoted(const string& s);
 
 inline string to_string_bool(bool f)
@@ -178,6 +182,56 @@ public:
     }
 };
 
+/**
+ *  @class      indentation
+ *  @brief      Indentation levels on output streams
+ * 
+ *  @details    Keeps an indentation level in the ostream's extensible
+ *              storage, which is adjusted with the indent and outdent
+ *              stream manipulators. Stream buffers that care about the
+ *              indentation level can query it with get_level.
+ */
+
+class indentation
+{
+public:
+    static int index(void)
+    {
+        static int idx = ios_base::xalloc();
+        return idx;
+    }
+
+    static void increase(ostream& os)
+    {
+        os.iword(index()) += 1;
+    }
+
+    static void decrease(ostream& os)
+    {
+        assert(os.iword(index()) > 0);
+        os.iword(index()) -= 1;
+    }
+
+    static int get_level(ostream& os)
+    {
+        return os.iword(index());
+    }
+};
+
+inline ostream& indent(ostream& os)
+{
+    indentation::increase(os);
+    return os;
+}
+
+inline ostream& outdent(ostream& os)
+{
+    indentation::decrease(os);
+    return os;
+}
+
+#ifdef _WIN32
+
 /**
  *  @class      font_gdi
  *  @brief      Windows HFONT wrapper
@@ -285,3 +339,4 @@ private:
     HFONT hfont;
 };
 
+#endif // _WIN32
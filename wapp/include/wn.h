@@ -24,6 +24,7 @@
 
 #include "dc.h"
 #include "len.h"
+#include "util.h"
 class TIMER;
 
 #ifndef CONSOLE
@@ -235,44 +236,6 @@ private:
     string buffer;
 };
 
-class indentation
-{
-public:
-    static int index(void)
-    {
-        static int idx = ios_base::xalloc();
-        return idx;
-    }
-
-    static void increase(ostream& os)
-    {
-        os.iword(index()) += 1;
-    }
-
-    static void decrease(ostream& os)
-    {
-        assert(os.iword(index()) > 0);
-        os.iword(index()) -= 1;
-    }
-
-    static int get_level(ostream& os)
-    {
-        return os.iword(index());
-    }
-};
-
-inline ostream& indent(ostream& os)
-{
-    indentation::increase(os);
-    return os;
-}
-
-inline ostream& outdent(ostream& os)
-{
-    indentation::decrease(os);
-    return os;
-}
-
 class WNSTREAM : public WN, public ostream
 {
 public: